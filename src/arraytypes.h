@@ -68,4 +68,6 @@ typedef Array<class GotoStatement *> GotoStatements;
 
 typedef Array<class TemplateInstance *> TemplateInstances;
 
+typedef Array<struct EscapeArg *> EscapeArgs;
+
 #endif
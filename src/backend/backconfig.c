@@ -45,11 +45,19 @@ void out_config_init(
         bool nofloat,   // do not pull in floating point code
         bool verbose,   // verbose compile
         bool optimize,  // optimize code
+        bool ssa,       // use SSA form in the optimizer
+        bool gvn,       // use global value numbering in the optimizer
         int symdebug,   // add symbolic debug information
                         // 1: D
                         // 2: fake it with C symbolic debug info
         bool alwaysframe,       // always create standard function frame
-        bool stackstomp         // add stack stomping code
+        bool stackstomp,        // add stack stomping code
+        bool compressdebug,     // compress debug sections
+        bool debugtypes,        // put struct debug info in type units
+        bool splitdebug,        // put debug info in a separate .dwo file
+        bool funcsections,      // put each function in its own section
+        bool datasections,      // put each global variable in its own section
+        bool vbounds            // list array bounds checks removed by the optimizer
         )
 {
 #if MARS
@@ -208,7 +216,13 @@ void out_config_init(
     configv.verbose = verbose;
 
     if (optimize)
+    {
         go_flag((char *)"-o");
+        if (ssa)
+            go_flag((char *)"+ssa");
+        if (gvn)
+            go_flag((char *)"+gvn");
+    }
 
     if (symdebug)
     {
@@ -244,6 +258,18 @@ void out_config_init(
         config.flags |= CFGalwaysframe;
     if (stackstomp)
         config.flags2 |= CFG2stomp;
+    if (compressdebug)
+        config.flags2 |= CFG2gz;
+    if (debugtypes)
+        config.flags2 |= CFG2gtypes;
+    if (splitdebug)
+        config.flags2 |= CFG2gsplit;
+    if (funcsections)
+        config.flags2 |= CFG2funcsec;
+    if (datasections)
+        config.flags2 |= CFG2datasec;
+    if (vbounds)
+        config.flags2 |= CFG2vbounds;
 
     ph_init();
     block_init();
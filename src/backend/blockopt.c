@@ -49,7 +49,6 @@ STATIC void block_check();
 STATIC void brtailrecursion();
 STATIC elem * assignparams(elem **pe,int *psi,elem **pe2);
 STATIC void emptyloops();
-int el_anyframeptr(elem *e);
 
 unsigned numblks;       // number of basic blocks in current function
 block *startblock;      /* beginning block of function                  */
@@ -444,6 +444,8 @@ typedef struct block
         {
             Symbol *flag;               // EH_DWARF: set to 'flag' symbol that encloses finally
             block *b_ret;               // EH_DWARF: associated BC_ret block
+            bool nothrow;               // EH_DWARF: try body cannot throw, so
+                                        // the landing pad is never entered
         } BI_FINALLY;
 
     } BS;
@@ -471,6 +473,7 @@ typedef struct block
         #define BFLoutsideprolog 0x800  // outside function prolog/epilog
         #define BFLlabel        0x2000  // block preceded by label
         #define BFLvolatile     0x4000  // block is volatile
+        #define BFLunrolled     0x8000  // loop has been partially unrolled
     code        *Bcode;         // code generated for this block
 
     unsigned Bweight;           // relative number of times this block
@@ -764,6 +764,12 @@ struct Config
 #define CFG2expand      0x8000  // expanded output to list file
 #define CFG2stomp       0x20000 // enable stack stomping code
 #define CFG2gms         0x40000 // optimize debug symbols for microsoft debuggers
+#define CFG2gz          0x80000 // compress debug sections
+#define CFG2gtypes      0x100000 // put struct debug info in type units
+#define CFG2gsplit      0x200000 // put debug info in a separate .dwo file
+#define CFG2funcsec     0x400000 // put each function in its own section
+#define CFG2datasec     0x800000 // put each global variable in its own section
+#define CFG2vbounds     0x1000000 // list array bounds checks removed by the optimizer
 #define CFGX2   (CFG2warniserr | CFG2phuse | CFG2phgen | CFG2phauto | \
                  CFG2once | CFG2hdrdebug | CFG2noobj | CFG2noerrmax | \
                  CFG2expand | CFG2nodeflib | CFG2stomp | CFG2gms)
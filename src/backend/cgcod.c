@@ -79,6 +79,7 @@ int stackchanged;               /* set to !=0 if any use of the stack
 int refparam;           // !=0 if we referenced any parameters
 int reflocal;           // !=0 if we referenced any locals
 bool anyiasm;           // !=0 if any inline assembler
+bool tailcalls;         // if calls ending a return block may become jumps
 char calledafunc;       // !=0 if we called a function
 char needframe;         // if TRUE, then we will need the frame
                         // pointer (BP for the 8088)
@@ -206,6 +207,12 @@ tryagain:
     mfuncreg = fregsaved;               // so we can see which are used
                                         // (bit is cleared each time
                                         //  we use one)
+    /* A call can only replace the caller's frame if nothing in it can
+     * still be referenced: no exception handling, no frame pointer handed
+     * to nested functions, and no address taken of a local or parameter.
+     */
+    tailcalls = I64 && config.flags4 & CFG4optimized &&
+                !(config.flags & CFGtrace) && !(config.flags2 & CFG2stomp);
     for (block* b = startblock; b; b = b->Bnext)
     {   memset(&b->Bregcon,0,sizeof(b->Bregcon));       // Clear out values in registers
         if (b->Belem)
@@ -214,6 +221,31 @@ tryagain:
             anyiasm = 1;                // we have inline assembler
         if (b->BC == BCret || b->BC == BCretexp)
             nretblocks++;
+        switch (b->BC)
+        {
+            case BCasm:
+            case BCtry:
+            case BCcatch:
+            case BC_try:
+            case BC_filter:
+            case BC_finally:
+            case BC_ret:
+            case BC_except:
+            case BCjcatch:
+            case BC_lpad:
+                tailcalls = false;
+                break;
+            default:
+                if (b->Belem && tailcalls && el_anyframeptr(b->Belem))
+                    tailcalls = false;
+                break;
+        }
+    }
+    for (int i = 0; tailcalls && i < globsym.top; i++)
+    {
+        Symbol *s = globsym.tab[i];
+        if (symbol_isintab(s) && !(s->Sflags & SFLunambig))
+            tailcalls = false;
     }
 
     if (!config.fulltypes || (config.flags4 & CFG4optimized))
@@ -3364,6 +3364,16 @@ STATIC code * funccall(elem *e,unsigned numpara,unsigned numalign,
 #endif
             ce = gencs(ce,farfunc ? 0x9A : 0xE8,0,fl,s);      // CALL extern
             code_orflag(ce, farfunc ? (CFseg | CFoff) : (CFselfrel | CFoff));
+            /* If this ends up as the last instruction of a return block,
+             * epilog() can replace it with a JMP. That's only possible when
+             * no arguments are on the stack, as they would have to be
+             * copied over the caller's own.
+             */
+            if (tailcalls && fl == FLfunc && !farfunc &&
+                !(s->Sflags & SFLexit) && s != tls_get_addr_sym &&
+                numalign == 0 && !usefuncarg &&
+                numpara == (config.exe == EX_WIN64 ? 4 * REGSIZE : 0))
+                code_orflag(ce, CFtailcall);
 #if TARGET_LINUX || TARGET_FREEBSD || TARGET_OPENBSD || TARGET_SOLARIS
             if (s == tls_get_addr_sym)
             {
@@ -858,7 +858,7 @@ code *cdmul(elem *e,regm_t *pretregs)
     byte = tybyte(e->Ety) != 0;
     uns = tyuns(tyml) || tyuns(e2->Ety);
     oper = e->Eoper;
-    unsigned rex = (I64 && sz == 8) ? REX_W : 0;
+    unsigned rex = (I64 && sz >= 8) ? REX_W : 0;
     unsigned grex = rex << 16;
 
     if (tyfloating(tyml))
@@ -931,10 +931,12 @@ code *cdmul(elem *e,regm_t *pretregs)
     case OPs16_32:
     case OPu32_64:
     case OPs32_64:
+    case OPu64_128:
+    case OPs64_128:
         if (sz != 2 * REGSIZE || oper != OPmul || e1->Eoper != e2->Eoper ||
             e1->Ecount || e2->Ecount)
             goto L2;
-        op = (e2->Eoper == opunslng) ? 4 : 5;
+        op = (e2->Eoper == opunslng || e2->Eoper == OPu64_128) ? 4 : 5;
         retregs = mAX;
         cl = codelem(e1->E1,&retregs,FALSE);    /* eval left leaf       */
         if (e2->E1->Eoper == OPvar ||
@@ -1523,11 +1525,11 @@ code *cdmul(elem *e,regm_t *pretregs)
                     ADD     EDX,ECX
                  */
                  cg = getregs(mAX|mDX|mCX);
-                 cg = gen2(cg,0x0FAF,modregrm(3,CX,AX));
-                 gen2(cg,0x0FAF,modregrm(3,DX,BX));
-                 gen2(cg,0x03,modregrm(3,CX,DX));
-                 gen2(cg,0xF7,modregrm(3,4,BX));
-                 gen2(cg,0x03,modregrm(3,DX,CX));
+                 cg = gen2(cg,0x0FAF,grex | modregrm(3,CX,AX));
+                 gen2(cg,0x0FAF,grex | modregrm(3,DX,BX));
+                 gen2(cg,0x03,grex | modregrm(3,CX,DX));
+                 gen2(cg,0xF7,grex | modregrm(3,4,BX));
+                 gen2(cg,0x03,grex | modregrm(3,DX,CX));
                  c = fixresult(e,mDX|mAX,pretregs);
             }
             else
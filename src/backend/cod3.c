@@ -3798,6 +3798,49 @@ code* prolog_loadparams(tym_t tyf, bool pushalloc, regm_t* namedargs)
     return c;
 }
 
+/*******************************
+ * Find a direct call that is the last thing done by return block b,
+ * so that epilog() can tear down the frame first and jump to the
+ * function instead. The callee then returns straight to our caller.
+ * Returns:
+ *      the CALL instruction, NULL if there isn't a suitable one
+ */
+
+STATIC code *cod3_tailcall(block *b)
+{
+    if (!tailcalls || (b->BC != BCret && b->BC != BCretexp))
+        return NULL;
+
+    // The frame must not be needed after the call, and the return must
+    // be a plain RET
+    tym_t tym = tybasic(funcsym_p->ty());
+    if (usednteh || Alloca.size || anyiasm ||
+        funcsym_p->ty() & (mTYnaked | mTYloadds) ||
+        tym == TYifunc || tym == TYhfunc || tyfarfunc(tym) ||
+        (typfunc(tym) && config.exe != EX_WIN64 && Para.offset))
+        return NULL;
+
+    // Anything done with the result after the call disqualifies it
+    code *cr = NULL;
+    for (code *c = b->Bcode; c; c = code_next(c))
+    {
+        if (c->Iop != NOP && (c->Iop & ESCAPEmask) != ESCAPE)
+            cr = c;
+    }
+    if (!cr || cr->Iop != CALL || !(cr->Iflags & CFtailcall))
+        return NULL;
+
+    // A label after the call is jumped to by code that did not make
+    // the call, such as the other side of (c ? f() : g()), and that
+    // code must still get the epilog and a RET
+    for (code *c = code_next(cr); c; c = code_next(c))
+    {
+        if (c->Iop == NOP)
+            return NULL;
+    }
+    return cr;
+}
+
 /*******************************
  * Generate and return function epilog.
  * Output:
@@ -3809,6 +3852,7 @@ void epilog(block *b)
     code *cr;
     code *ce;
     code *cpopds;
+    code *ctail;                        // CALL to turn into a JMP
     unsigned reg;
     unsigned regx;                      // register that's not a return reg
     regm_t topop,regm;
@@ -3822,6 +3866,7 @@ void epilog(block *b)
     tyf = funcsym_p->ty();
     tym = tybasic(tyf);
     farfunc = tyfarfunc(tym);
+    ctail = cod3_tailcall(b);
     if (!(b->Bflags & BFLepilog))       // if no epilog code
         goto Lret;                      // just generate RET
     regx = (b->BC == BCret) ? AX : CX;
@@ -3983,7 +4028,8 @@ void epilog(block *b)
             if (config.wflags & WFincbp && farfunc)
                 gen1(c,0x48 + BP);              // DEC BP
         }
-        else if (xlocalsize == REGSIZE && (!I16 || b->BC == BCret))
+        else if (xlocalsize == REGSIZE && (!I16 || b->BC == BCret) &&
+                 !ctail)                // regx may hold an argument
         {   mfuncreg &= ~mask[regx];
             c = gen1(c,0x58 + regx);                    // POP regx
         }
@@ -3994,7 +4040,15 @@ void epilog(block *b)
     {
 Lret:
         op = tyfarfunc(tym) ? 0xCA : 0xC2;
-        if (tym == TYhfunc)
+        if (ctail)
+        {   // Jump to the function rather than call it and return
+            code *cj = gen(CNIL,ctail);
+            cj->Iop = JMP;
+            cj->Iflags &= ~CFtailcall;
+            c = cat(c,cj);
+            ctail->Iop = NOP;
+        }
+        else if (tym == TYhfunc)
         {
             c = genc2(c,0xC2,0,4);                      // RET 4
         }
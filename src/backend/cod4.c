@@ -2764,7 +2764,8 @@ code *cdshtlng(elem *e,regm_t *pretregs)
   else if (
            op == OPnp_fp ||
            (I16 && op == OPu16_32) ||
-           (I32 && op == OPu32_64)
+           (I32 && op == OPu32_64) ||
+           (I64 && op == OPu64_128)
           )
   {
         /* Result goes into a register pair.
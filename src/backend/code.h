@@ -233,6 +233,7 @@ extern  int stackchanged;
 extern  int refparam;
 extern  int reflocal;
 extern  bool anyiasm;
+extern  bool tailcalls;
 extern  char calledafunc;
 extern  code *(*cdxxx[])(elem *,regm_t *);
 
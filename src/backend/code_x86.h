@@ -392,6 +392,8 @@ struct code
  */
 #define CFREL       0x7000000
 
+#define CFtailcall  0x8000000   // direct CALL that epilog() may turn into a JMP
+
 #define CFPREFIX (CFSEG | CFopsize | CFaddrsize)
 #define CFSEG   (CFes | CFss | CFds | CFcs | CFfs | CFgs)
 
@@ -0,0 +1,578 @@
+/* Compiler implementation of the D programming language
+ * Copyright (c) 2016 by Digital Mars
+ * All Rights Reserved
+ * http://www.digitalmars.com
+ * Distributed under the Boost Software License, Version 1.0.
+ * http://www.boost.org/LICENSE_1_0.txt
+ * https://github.com/dlang/dmd/blob/master/src/backend/deflate.c
+ */
+
+/* Compressor producing zlib format data (RFC 1950, RFC 1951),
+ * used for compressed debug sections.
+ * LZ77 matches are found with hash chains, and each block is coded with
+ * whichever of the fixed or a dynamic Huffman code is smaller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "outbuf.h"
+
+#if TARGET_WINDOS
+static char __file__[] = __FILE__;      // for tassert.h
+#include        "tassert.h"
+#else
+#include        <assert.h>
+#endif
+
+#define WSIZE           32768           // LZ77 window size
+#define MIN_MATCH       3
+#define MAX_MATCH       258
+#define MAX_CHAIN       64              // hash chain entries tried per position
+#define NICE_MATCH      128             // stop searching when a match is this long
+#define HASH_BITS       15
+#define HASH_SIZE       (1 << HASH_BITS)
+#define BLOCK_SYMS      32768           // symbols per block
+
+#define LITLEN_CODES    288             // 0..255 literals, 256 end of block, 257..285 lengths
+#define DIST_CODES      30
+#define CL_CODES        19              // code length codes
+#define END_BLOCK       256
+#define MAX_BITS        15              // longest literal/length or distance code
+#define MAX_CL_BITS     7               // longest code length code
+
+static const unsigned short length_base[29] =
+{   3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,
+    35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const unsigned char length_extra[29] =
+{   0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const unsigned short dist_base[DIST_CODES] =
+{   1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,
+    257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const unsigned char dist_extra[DIST_CODES] =
+{   0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+// Order in which code length code lengths are sent
+static const unsigned char cl_order[CL_CODES] =
+{   16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+/*****************************************
+ * Output bits least significant bit first.
+ */
+
+struct BitWriter
+{
+    Outbuffer *buf;
+    unsigned bits;
+    int nbits;
+
+    void put(unsigned value, int n)
+    {
+        bits |= value << nbits;
+        nbits += n;
+        while (nbits >= 8)
+        {
+            buf->writeByte(bits & 0xFF);
+            bits >>= 8;
+            nbits -= 8;
+        }
+    }
+
+    // Huffman codes are sent most significant bit first
+    void putcode(unsigned code, int n)
+    {
+        unsigned r = 0;
+        for (int i = 0; i < n; i++)
+        {
+            r = (r << 1) | (code & 1);
+            code >>= 1;
+        }
+        put(r, n);
+    }
+
+    void flush()
+    {
+        if (nbits)
+            buf->writeByte(bits & 0xFF);
+        bits = 0;
+        nbits = 0;
+    }
+};
+
+/*****************************************
+ * Return length code 0..28 for match length len.
+ */
+
+static int length_code(unsigned len)
+{
+    int i = 0;
+    while (i < 28 && length_base[i + 1] <= len)
+        i++;
+    return i;
+}
+
+/*****************************************
+ * Return distance code for distance dist.
+ */
+
+static int dist_code(unsigned dist)
+{
+    int i = 0;
+    while (i < DIST_CODES - 1 && dist_base[i + 1] <= dist)
+        i++;
+    return i;
+}
+
+/*****************************************
+ * Compute Huffman code lengths for freq[0 .. n] into lens[],
+ * no longer than maxbits.
+ */
+
+static void huffman_lengths(const unsigned *freq, int n, int maxbits, unsigned char *lens)
+{
+    int sorted[LITLEN_CODES];
+    int nsyms = 0;
+
+    memset(lens, 0, n);
+    for (int i = 0; i < n; i++)
+    {
+        if (freq[i])
+            sorted[nsyms++] = i;
+    }
+    if (nsyms == 0)
+        return;
+    if (nsyms == 1)
+    {   // Add a second code so the code is complete
+        lens[sorted[0]] = 1;
+        lens[sorted[0] ? 0 : 1] = 1;
+        return;
+    }
+
+    // Sort symbols by ascending frequency (insertion sort, n is small)
+    for (int i = 1; i < nsyms; i++)
+    {
+        int s = sorted[i];
+        int j = i;
+        for (; j > 0 && freq[sorted[j - 1]] > freq[s]; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = s;
+    }
+
+    /* Build the tree with two queues: the sorted leaves, and the
+     * internal nodes which are created in ascending weight order.
+     */
+    unsigned weight[2 * LITLEN_CODES];
+    int parent[2 * LITLEN_CODES];
+    for (int i = 0; i < nsyms; i++)
+        weight[i] = freq[sorted[i]];
+    int leaf = 0;
+    int node = nsyms;
+    int next = nsyms;
+    for (int k = 0; k < nsyms - 1; k++)
+    {
+        int pick[2];
+        for (int m = 0; m < 2; m++)
+        {
+            if (leaf < nsyms && (node == next || weight[leaf] <= weight[node]))
+                pick[m] = leaf++;
+            else
+                pick[m] = node++;
+        }
+        weight[next] = weight[pick[0]] + weight[pick[1]];
+        parent[pick[0]] = next;
+        parent[pick[1]] = next;
+        next++;
+    }
+
+    // Depth of each node, the root is next - 1
+    int depth[2 * LITLEN_CODES];
+    depth[next - 1] = 0;
+    for (int i = next - 2; i >= 0; i--)
+        depth[i] = depth[parent[i]] + 1;
+
+    /* Limit the lengths to maxbits, then fix up the Kraft sum by
+     * lengthening shorter codes.
+     */
+    int count[MAX_BITS + 2];
+    memset(count, 0, sizeof(count));
+    for (int i = 0; i < nsyms; i++)
+        count[depth[i] > maxbits ? maxbits : depth[i]]++;
+    unsigned total = 0;
+    for (int i = 1; i <= maxbits; i++)
+        total += count[i] << (maxbits - i);
+    while (total > (1U << maxbits))
+    {
+        count[maxbits]--;
+        for (int i = maxbits - 1; i > 0; i--)
+        {
+            if (count[i])
+            {
+                count[i]--;
+                count[i + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // The most frequent symbols get the shortest codes
+    int s = nsyms;
+    for (int len = 1; len <= maxbits; len++)
+    {
+        for (int i = 0; i < count[len]; i++)
+            lens[sorted[--s]] = len;
+    }
+}
+
+/*****************************************
+ * Compute canonical Huffman codes from code lengths.
+ */
+
+static void huffman_codes(const unsigned char *lens, int n, unsigned short *codes)
+{
+    unsigned short count[MAX_BITS + 1];
+    unsigned short next[MAX_BITS + 1];
+
+    memset(count, 0, sizeof(count));
+    for (int i = 0; i < n; i++)
+        count[lens[i]]++;
+    count[0] = 0;
+    unsigned code = 0;
+    for (int len = 1; len <= MAX_BITS; len++)
+    {
+        code = (code + count[len - 1]) << 1;
+        next[len] = code;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (lens[i])
+            codes[i] = next[lens[i]]++;
+    }
+}
+
+/*****************************************
+ * Symbols of a block waiting to be output.
+ */
+
+struct Block
+{
+    unsigned short litlen[BLOCK_SYMS];  // literal byte, or match length
+    unsigned short dist[BLOCK_SYMS];    // 0 for a literal, or match distance
+    unsigned nsyms;
+    unsigned litfreq[LITLEN_CODES];
+    unsigned distfreq[DIST_CODES];
+};
+
+/*****************************************
+ * Write the symbols with the given code.
+ */
+
+static void write_symbols(BitWriter *bw, Block *b,
+        const unsigned char *litlens, const unsigned short *litcodes,
+        const unsigned char *distlens, const unsigned short *distcodes)
+{
+    for (unsigned i = 0; i < b->nsyms; i++)
+    {
+        unsigned v = b->litlen[i];
+        unsigned d = b->dist[i];
+        if (!d)
+        {
+            bw->putcode(litcodes[v], litlens[v]);
+            continue;
+        }
+        int lc = length_code(v);
+        bw->putcode(litcodes[257 + lc], litlens[257 + lc]);
+        if (length_extra[lc])
+            bw->put(v - length_base[lc], length_extra[lc]);
+        int dc = dist_code(d);
+        bw->putcode(distcodes[dc], distlens[dc]);
+        if (dist_extra[dc])
+            bw->put(d - dist_base[dc], dist_extra[dc]);
+    }
+    bw->putcode(litcodes[END_BLOCK], litlens[END_BLOCK]);
+}
+
+/*****************************************
+ * Return number of bits needed for the symbols with the given code lengths.
+ */
+
+static unsigned long long block_cost(Block *b, const unsigned char *litlens, const unsigned char *distlens)
+{
+    unsigned long long cost = 0;
+    for (int i = 0; i < LITLEN_CODES; i++)
+    {
+        cost += (unsigned long long)b->litfreq[i] * litlens[i];
+        if (i >= 257 && i < 257 + 29)
+            cost += (unsigned long long)b->litfreq[i] * length_extra[i - 257];
+    }
+    for (int i = 0; i < DIST_CODES; i++)
+        cost += (unsigned long long)b->distfreq[i] * (distlens[i] + dist_extra[i]);
+    return cost;
+}
+
+/*****************************************
+ * Output block b, last is true for the final block.
+ */
+
+static void write_block(BitWriter *bw, Block *b, bool last)
+{
+    b->litfreq[END_BLOCK]++;
+
+    // Fixed code
+    unsigned char fixedlit[LITLEN_CODES];
+    unsigned char fixeddist[DIST_CODES];
+    for (int i = 0; i < LITLEN_CODES; i++)
+        fixedlit[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    memset(fixeddist, 5, sizeof(fixeddist));
+
+    // Dynamic code
+    unsigned char litlens[LITLEN_CODES];
+    unsigned char distlens[DIST_CODES];
+    huffman_lengths(b->litfreq, 286, MAX_BITS, litlens);
+    litlens[286] = litlens[287] = 0;
+    huffman_lengths(b->distfreq, DIST_CODES, MAX_BITS, distlens);
+
+    int hlit = 286;
+    while (hlit > 257 && !litlens[hlit - 1])
+        hlit--;
+    int hdist = DIST_CODES;
+    while (hdist > 1 && !distlens[hdist - 1])
+        hdist--;
+
+    /* Run length encode the code lengths of both codes, which are sent
+     * as one sequence, with the code length codes 16, 17 and 18.
+     */
+    unsigned char all[286 + DIST_CODES];
+    memcpy(all, litlens, hlit);
+    memcpy(all + hlit, distlens, hdist);
+    int nall = hlit + hdist;
+    unsigned char rle[286 + DIST_CODES];        // code length code
+    unsigned char rlextra[286 + DIST_CODES];    // its extra bits
+    int nrle = 0;
+    unsigned clfreq[CL_CODES];
+    memset(clfreq, 0, sizeof(clfreq));
+    for (int i = 0; i < nall; )
+    {
+        unsigned char len = all[i];
+        int run = 1;
+        while (i + run < nall && all[i + run] == len)
+            run++;
+        if (len == 0 && run >= 3)
+        {
+            if (run > 138)
+                run = 138;
+            rle[nrle] = run <= 10 ? 17 : 18;
+            rlextra[nrle] = run <= 10 ? run - 3 : run - 11;
+        }
+        else if (len != 0 && run >= 4)
+        {   // The first one is sent as is, then repeat it 3 to 6 times
+            if (run > 7)
+                run = 7;
+            rle[nrle] = len;
+            rlextra[nrle] = 0;
+            clfreq[len]++;
+            nrle++;
+            rle[nrle] = 16;
+            rlextra[nrle] = run - 4;
+        }
+        else
+        {
+            run = 1;
+            rle[nrle] = len;
+            rlextra[nrle] = 0;
+        }
+        clfreq[rle[nrle]]++;
+        nrle++;
+        i += run;
+    }
+
+    unsigned char cllens[CL_CODES];
+    huffman_lengths(clfreq, CL_CODES, MAX_CL_BITS, cllens);
+    int hclen = CL_CODES;
+    while (hclen > 4 && !cllens[cl_order[hclen - 1]])
+        hclen--;
+
+    unsigned long long dyncost = 5 + 5 + 4 + 3 * hclen;
+    for (int i = 0; i < nrle; i++)
+    {
+        int c = rle[i];
+        dyncost += cllens[c] + (c == 16 ? 2 : c == 17 ? 3 : c == 18 ? 7 : 0);
+    }
+    dyncost += block_cost(b, litlens, distlens);
+    unsigned long long fixedcost = block_cost(b, fixedlit, fixeddist);
+
+    unsigned short litcodes[LITLEN_CODES];
+    unsigned short distcodes[DIST_CODES];
+    bw->put(last, 1);
+    if (fixedcost <= dyncost)
+    {
+        bw->put(1, 2);                  // BTYPE fixed Huffman
+        huffman_codes(fixedlit, LITLEN_CODES, litcodes);
+        huffman_codes(fixeddist, DIST_CODES, distcodes);
+        write_symbols(bw, b, fixedlit, litcodes, fixeddist, distcodes);
+    }
+    else
+    {
+        bw->put(2, 2);                  // BTYPE dynamic Huffman
+        bw->put(hlit - 257, 5);
+        bw->put(hdist - 1, 5);
+        bw->put(hclen - 4, 4);
+        for (int i = 0; i < hclen; i++)
+            bw->put(cllens[cl_order[i]], 3);
+        unsigned short clcodes[CL_CODES];
+        huffman_codes(cllens, CL_CODES, clcodes);
+        for (int i = 0; i < nrle; i++)
+        {
+            int c = rle[i];
+            bw->putcode(clcodes[c], cllens[c]);
+            if (c == 16)
+                bw->put(rlextra[i], 2);
+            else if (c == 17)
+                bw->put(rlextra[i], 3);
+            else if (c == 18)
+                bw->put(rlextra[i], 7);
+        }
+        huffman_codes(litlens, LITLEN_CODES, litcodes);
+        huffman_codes(distlens, DIST_CODES, distcodes);
+        write_symbols(bw, b, litlens, litcodes, distlens, distcodes);
+    }
+
+    b->nsyms = 0;
+    memset(b->litfreq, 0, sizeof(b->litfreq));
+    memset(b->distfreq, 0, sizeof(b->distfreq));
+}
+
+/*****************************************
+ * Adler-32 checksum of data[0 .. nbytes].
+ */
+
+static unsigned adler32(const unsigned char *data, size_t nbytes)
+{
+    unsigned a = 1;
+    unsigned b = 0;
+    while (nbytes)
+    {
+        size_t n = nbytes < 5552 ? nbytes : 5552;       // largest n with no overflow
+        nbytes -= n;
+        for (size_t i = 0; i < n; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+        data += n;
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+static inline unsigned hash3(const unsigned char *p)
+{
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+/*****************************************
+ * Append data[0 .. nbytes] compressed in zlib format to buf.
+ */
+
+void zlib_compress(Outbuffer *buf, const unsigned char *data, size_t nbytes)
+{
+    buf->reserve(nbytes / 4 + 64);
+    buf->writeByte(0x78);               // CM = deflate, CINFO = 32K window
+    buf->writeByte(0x9C);               // FLEVEL = default, FCHECK
+
+    BitWriter bw;
+    bw.buf = buf;
+    bw.bits = 0;
+    bw.nbits = 0;
+
+    Block *b = (Block *)calloc(1, sizeof(Block));
+    int *head = (int *)malloc(HASH_SIZE * sizeof(int));
+    int *prev = (int *)malloc(WSIZE * sizeof(int));
+    assert(b && head && prev);
+    for (int i = 0; i < HASH_SIZE; i++)
+        head[i] = -1;
+
+    size_t pos = 0;
+    while (pos < nbytes)
+    {
+        unsigned bestlen = 0;
+        unsigned bestdist = 0;
+        if (pos + MIN_MATCH <= nbytes)
+        {
+            unsigned h = hash3(data + pos);
+            size_t maxlen = nbytes - pos;
+            if (maxlen > MAX_MATCH)
+                maxlen = MAX_MATCH;
+            int cand = head[h];
+            for (int chain = 0; cand >= 0 && chain < MAX_CHAIN; chain++)
+            {
+                if (pos - cand > WSIZE)
+                    break;
+                const unsigned char *p = data + cand;
+                const unsigned char *q = data + pos;
+                if (p[bestlen] == q[bestlen] && p[0] == q[0])
+                {
+                    unsigned len = 0;
+                    while (len < maxlen && p[len] == q[len])
+                        len++;
+                    if (len > bestlen)
+                    {
+                        bestlen = len;
+                        bestdist = pos - cand;
+                        if (len >= NICE_MATCH || len == maxlen)
+                            break;
+                    }
+                }
+                int next = prev[cand & (WSIZE - 1)];
+                if (next >= cand)
+                    break;                      // entry was overwritten
+                cand = next;
+            }
+        }
+
+        if (bestlen >= MIN_MATCH)
+        {
+            b->litlen[b->nsyms] = bestlen;
+            b->dist[b->nsyms] = bestdist;
+            b->nsyms++;
+            b->litfreq[257 + length_code(bestlen)]++;
+            b->distfreq[dist_code(bestdist)]++;
+        }
+        else
+        {
+            bestlen = 1;
+            b->litlen[b->nsyms] = data[pos];
+            b->dist[b->nsyms] = 0;
+            b->nsyms++;
+            b->litfreq[data[pos]]++;
+        }
+
+        // Insert the positions covered into the hash chains
+        for (size_t end = pos + bestlen; pos < end; pos++)
+        {
+            if (pos + MIN_MATCH <= nbytes)
+            {
+                unsigned h = hash3(data + pos);
+                prev[pos & (WSIZE - 1)] = head[h];
+                head[h] = pos;
+            }
+        }
+
+        if (b->nsyms == BLOCK_SYMS)
+            write_block(&bw, b, pos == nbytes);
+    }
+    if (b->nsyms || !nbytes)
+        write_block(&bw, b, true);
+    bw.flush();
+
+    free(prev);
+    free(head);
+    free(b);
+
+    unsigned adler = adler32(data, nbytes);
+    buf->writeByte(adler >> 24);        // big endian
+    buf->writeByte(adler >> 16);
+    buf->writeByte(adler >> 8);
+    buf->writeByte(adler);
+}
@@ -39,7 +39,7 @@
 #include        "dt.h"
 #include        "rtlsym.h"
 
-#include        "aa.h"
+#include        "hashtab.h"
 #include        "tinfo.h"
 
 #if ELFOBJ
@@ -437,89 +437,97 @@ static Outbuffer *debug_loc_buf;
 static IDXSEC abbrevseg;
 static Outbuffer *abbrevbuf;
 
-/* DWARF 7.5.3: "Each declaration begins with an unsigned LEB128 number
- * representing the abbreviation code itself."
- */
-static unsigned abbrevcode = 1;
-static AArray *abbrev_table;
-static int hasModname;    // 1 if has DW_TAG_module
-
-// .debug_info
-static IDXSEC infoseg;
-static Outbuffer *infobuf;
-static AArray *infoFileName_table;
-
-static AArray *type_table;
-static AArray *functype_table;  // not sure why this cannot be combined with type_table
-static Outbuffer *functypebuf;
+/* ====================== Hash tables of byte strings ================== */
 
-// typeinfo declarations for hash of char*
+static inline hash_t dwarf_hash(const unsigned char *p, size_t length)
+{
+    hash_t hash = 0;
+    for (size_t i = 0; i < length; i++)
+        hash = hash * 11 + p[i];
+    return hash;
+}
 
+// File name in the .debug_line header
 struct Abuf
 {
     const unsigned char *buf;
     size_t length;
 };
 
-struct TypeInfo_Abuf : TypeInfo
+struct AbufTraits
 {
-    const char* toString();
-    hash_t getHash(void *p);
-    int equals(void *p1, void *p2);
-    int compare(void *p1, void *p2);
-    size_t tsize();
-    void swap(void *p1, void *p2);
-};
+    static hash_t hash(const Abuf& a)
+    {
+        return dwarf_hash(a.buf, a.length);
+    }
 
-TypeInfo_Abuf ti_abuf;
+    static bool equals(const Abuf& a1, const Abuf& a2)
+    {
+        return a1.length == a2.length &&
+            memcmp(a1.buf, a2.buf, a1.length) == 0;
+    }
+};
 
-const char* TypeInfo_Abuf::toString()
+// Type entry in buf->buf[start .. end]
+struct Atype
 {
-    return "Abuf";
-}
+    Outbuffer *buf;
+    size_t start;
+    size_t end;
+};
 
-hash_t TypeInfo_Abuf::getHash(void *p)
+struct AtypeTraits
 {
-    Abuf a = *(Abuf *)p;
-
-    hash_t hash = 0;
-    for (size_t i = 0; i < a.length; i++)
-        hash = hash * 11 + a.buf[i];
+    static hash_t hash(const Atype& a)
+    {
+        return dwarf_hash(a.buf->buf + a.start, a.end - a.start);
+    }
 
-    return hash;
-}
+    static bool equals(const Atype& a1, const Atype& a2)
+    {
+        size_t len = a1.end - a1.start;
+        return len == a2.end - a2.start &&
+            memcmp(a1.buf->buf + a1.start, a2.buf->buf + a2.start, len) == 0;
+    }
+};
 
-int TypeInfo_Abuf::equals(void *p1, void *p2)
+// Abbreviation in abbrevbuf->buf[start .. end]
+struct Adata
 {
-    Abuf a1 = *(Abuf*)p1;
-    Abuf a2 = *(Abuf*)p2;
-
-    return a1.length == a2.length &&
-        memcmp(a1.buf, a2.buf, a1.length) == 0;
-}
+    size_t start;
+    size_t end;
+};
 
-int TypeInfo_Abuf::compare(void *p1, void *p2)
+struct AdataTraits
 {
-    Abuf a1 = *(Abuf*)p1;
-    Abuf a2 = *(Abuf*)p2;
+    static hash_t hash(const Adata& a)
+    {
+        return dwarf_hash(abbrevbuf->buf + a.start, a.end - a.start);
+    }
 
-    if (a1.length == a2.length)
-        return memcmp(a1.buf, a2.buf, a1.length);
-    else if (a1.length < a2.length)
-        return -1;
-    else
-        return 1;
-}
+    static bool equals(const Adata& a1, const Adata& a2)
+    {
+        size_t len = a1.end - a1.start;
+        return len == a2.end - a2.start &&
+            memcmp(abbrevbuf->buf + a1.start, abbrevbuf->buf + a2.start, len) == 0;
+    }
+};
 
-size_t TypeInfo_Abuf::tsize()
-{
-    return sizeof(Abuf);
-}
+/* DWARF 7.5.3: "Each declaration begins with an unsigned LEB128 number
+ * representing the abbreviation code itself."
+ */
+static unsigned abbrevcode = 1;
+static HashTab<Adata, unsigned, AdataTraits> *abbrev_table;
+static int hasModname;    // 1 if has DW_TAG_module
 
-void TypeInfo_Abuf::swap(void *p1, void *p2)
-{
-    assert(0);
-}
+// .debug_info
+static IDXSEC infoseg;
+static Outbuffer *infobuf;
+static HashTab<Abuf, unsigned, AbufTraits> *infoFileName_table;
+
+static HashTab<Atype, unsigned, AtypeTraits> *type_table;
+static HashTab<Atype, unsigned, AtypeTraits> *functype_table;  // not sure why this cannot be combined with type_table
+static Outbuffer *functypebuf;
 
 #pragma pack(1)
 struct DebugInfoHeader
@@ -539,6 +547,97 @@ static DebugInfoHeader debuginfo_init =
 
 static DebugInfoHeader debuginfo;
 
+/* With -gtypes, each struct goes in a type unit of its own in .debug_types,
+ * and the compile unit refers to it by its signature.
+ * The type unit is in a COMDAT group named by the signature, so the linker
+ * keeps only one of the copies in the object files.
+ */
+#pragma pack(1)
+struct DebugTypesHeader
+{   unsigned total_length;
+    unsigned short version;
+    unsigned abbrev_offset;
+    unsigned char address_size;
+    unsigned long long signature;
+    unsigned type_offset;
+};
+#pragma pack()
+
+struct TypesigTraits
+{
+    static hash_t hash(const unsigned long long& sig)
+    {
+        return (hash_t)(sig ^ (sig >> 32));
+    }
+
+    static bool equals(const unsigned long long& sig1, const unsigned long long& sig2)
+    {
+        return sig1 == sig2;
+    }
+};
+
+static HashTab<unsigned long long, int, TypesigTraits> *typeunit_table;  // signatures already seen
+static Outbuffer *typeunit_pending;     // type*'s of the type units still to write
+static Classsym *typeunit_sym;          // struct of the type unit being written, NULL for the compile unit
+
+/* With -gsplit-dwarf, the compile unit with its abbreviations and location
+ * lists goes in a .dwo file next to the object file, which the linker
+ * never reads. The object file only has a skeleton compile unit naming
+ * the .dwo file, and the line numbers, address ranges and call frames.
+ * Since the .dwo file has no relocations, the addresses it needs are
+ * put in .debug_addr in the object file and referred to by index.
+ */
+static Outbuffer *dwo_infobuf;          // .debug_info.dwo
+static Outbuffer *dwo_abbrevbuf;        // .debug_abbrev.dwo
+static Outbuffer *dwo_locbuf;           // .debug_loc.dwo
+static size_t dwo_id_offset;            // of DW_AT_GNU_dwo_id in dwo_infobuf
+static char *comp_dir;                  // DW_AT_comp_dir
+
+// .debug_addr
+static int debug_addr_seg;
+static Outbuffer *debug_addr_buf;
+
+static void dwarf_termdwo(const char *objfilename);
+
+static bool dwarf_split()
+{
+#if ELFOBJ
+    return (config.flags2 & CFG2gsplit) != 0;
+#else
+    return false;
+#endif
+}
+
+static bool dwarf_typeunits()
+{
+#if ELFOBJ
+    // Type units would have to go in the .dwo file too, not supported
+    return (config.flags2 & CFG2gtypes) && !dwarf_split();
+#else
+    return false;
+#endif
+}
+
+/* Form of offsets into other debug sections, DW_FORM_data4 is not
+ * one of them anymore in DWARF 4.
+ */
+static unsigned char dwarf_secoffset_form()
+{
+    return debuginfo.version >= 4 ? DW_FORM_sec_offset : DW_FORM_data4;
+}
+
+/*****************************************
+ * Add the address offset in segment seg to .debug_addr.
+ * Returns:
+ *      index of the address, for DW_FORM_GNU_addr_index and DW_OP_GNU_addr_index
+ */
+static unsigned dwarf_addr_index(int seg, targ_size_t offset)
+{
+    unsigned index = debug_addr_buf->size() / (I64 ? 8 : 4);
+    dwarf_appreladdr(debug_addr_seg, debug_addr_buf, seg, offset);
+    return index;
+}
+
 // .debug_line
 static IDXSEC lineseg;
 static Outbuffer *linebuf;
@@ -1006,9 +1105,22 @@ void dwarf_initfile(const char *filename)
 
     /* ======================================== */
 
-    debug_loc_seg = dwarf_getsegment(debug_loc, 0);
-    debug_loc_secidx = SegData[debug_loc_seg]->SDshtidx;
-    debug_loc_buf = SegData[debug_loc_seg]->SDbuf;
+    if (dwarf_split())
+    {
+        if (!dwo_locbuf)
+            dwo_locbuf = new Outbuffer();
+        dwo_locbuf->setsize(0);
+        debug_loc_buf = dwo_locbuf;
+
+        debug_addr_seg = dwarf_getsegment(".debug_addr", 0);
+        debug_addr_buf = SegData[debug_addr_seg]->SDbuf;
+    }
+    else
+    {
+        debug_loc_seg = dwarf_getsegment(debug_loc, 0);
+        debug_loc_secidx = SegData[debug_loc_seg]->SDshtidx;
+        debug_loc_buf = SegData[debug_loc_seg]->SDbuf;
+    }
     debug_loc_buf->reserve(1000);
 
     /* ======================================== */
@@ -1018,6 +1130,11 @@ void dwarf_initfile(const char *filename)
         infoFileName_table = NULL;
     }
 
+    if (typeunit_table)
+    {   delete typeunit_table;
+        typeunit_table = NULL;
+    }
+
     lineseg = dwarf_getsegment(debug_line, 0);
     linebuf = SegData[lineseg]->SDbuf;
 
@@ -1046,6 +1163,13 @@ void dwarf_initfile(const char *filename)
 
     abbrevseg = dwarf_getsegment(debug_abbrev, 0);
     abbrevbuf = SegData[abbrevseg]->SDbuf;
+    if (dwarf_split())
+    {   // The skeleton's abbreviations are written by dwarf_termfile()
+        if (!dwo_abbrevbuf)
+            dwo_abbrevbuf = new Outbuffer();
+        dwo_abbrevbuf->setsize(0);
+        abbrevbuf = dwo_abbrevbuf;
+    }
     abbrevcode = 1;
 
     // Free only if starting another file. Waste of time otherwise.
@@ -1069,21 +1193,50 @@ void dwarf_initfile(const char *filename)
         DW_AT_stmt_list, DW_FORM_data4,
         0,               0,
     };
+    static unsigned char abbrevDwoHeader[] =
+    {
+        1,                      // abbreviation code
+        DW_TAG_compile_unit,
+        1,
+        DW_AT_producer,  DW_FORM_string,
+        DW_AT_language,  DW_FORM_data1,
+        DW_AT_name,      DW_FORM_string,
+        DW_AT_comp_dir,  DW_FORM_string,
+        0xB1, 0x42,      DW_FORM_data8,         // DW_AT_GNU_dwo_id
+        0,               0,
+    };
+
+    debuginfo = debuginfo_init;
+    if (I64)
+        debuginfo.address_size = 8;
+    if (dwarf_typeunits() || dwarf_split())
+    {   // DW_FORM_ref_sig8 and split DWARF need DWARF 4
+        debuginfo.version = 4;
+    }
+    abbrevHeader[16] = dwarf_secoffset_form();  // DW_AT_ranges
+    abbrevHeader[18] = dwarf_secoffset_form();  // DW_AT_stmt_list
 
-    abbrevbuf->write(abbrevHeader,sizeof(abbrevHeader));
+    if (dwarf_split())
+        abbrevbuf->write(abbrevDwoHeader,sizeof(abbrevDwoHeader));
+    else
+        abbrevbuf->write(abbrevHeader,sizeof(abbrevHeader));
 
     /* ======================================== */
 
     infoseg = dwarf_getsegment(debug_info, 0);
     infobuf = SegData[infoseg]->SDbuf;
-
-    debuginfo = debuginfo_init;
-    if (I64)
-        debuginfo.address_size = 8;
+    if (dwarf_split())
+    {   // The skeleton compile unit is written by dwarf_termfile()
+        if (!dwo_infobuf)
+            dwo_infobuf = new Outbuffer();
+        dwo_infobuf->setsize(0);
+        infobuf = dwo_infobuf;
+    }
 
     infobuf->write(&debuginfo, sizeof(debuginfo));
 #if ELFOBJ
-    dwarf_addrel(infoseg,6,abbrevseg);
+    if (!dwarf_split())
+        dwarf_addrel(infoseg,6,abbrevseg);
 #endif
 
     infobuf->writeuLEB128(1);                   // abbreviation code
@@ -1129,37 +1282,53 @@ void dwarf_initfile(const char *filename)
 #endif
     //infobuf->write32(Obj::addstr(debug_str_buf, cwd)); // DW_AT_comp_dir as DW_FORM_strp, doesn't work on some systems
     infobuf->writeString(cwd);                  // DW_AT_comp_dir as DW_FORM_string
-    free(cwd);
+    free(comp_dir);
+    comp_dir = cwd;                             // the skeleton needs it too
 
-    append_addr(infobuf, 0);               // DW_AT_low_pc
-    append_addr(infobuf, 0);               // DW_AT_entry_pc
+    if (dwarf_split())
+    {   // The rest is in the skeleton
+        dwo_id_offset = infobuf->size();
+        infobuf->write64(0);                    // DW_AT_GNU_dwo_id
+    }
+    else
+    {
+        append_addr(infobuf, 0);                // DW_AT_low_pc
+        append_addr(infobuf, 0);                // DW_AT_entry_pc
 
 #if ELFOBJ
-    dwarf_addrel(infoseg,infobuf->size(),debug_ranges_seg);
+        dwarf_addrel(infoseg,infobuf->size(),debug_ranges_seg);
 #endif
-    infobuf->write32(0);                        // DW_AT_ranges
+        infobuf->write32(0);                    // DW_AT_ranges
 
 #if ELFOBJ
-    dwarf_addrel(infoseg,infobuf->size(),lineseg);
+        dwarf_addrel(infoseg,infobuf->size(),lineseg);
 #endif
-    infobuf->write32(0);                        // DW_AT_stmt_list
+        infobuf->write32(0);                    // DW_AT_stmt_list
+    }
 
     memset(typidx_tab, 0, sizeof(typidx_tab));
 
     /* ======================================== */
 
-    seg = dwarf_getsegment(debug_pubnames, 0);
-    debug_pubnames_secidx = SegData[seg]->SDshtidx;
-    debug_pubnames_buf = SegData[seg]->SDbuf;
-    debug_pubnames_buf->reserve(1000);
+    /* The names would refer to DIEs of the compile unit in the .dwo file,
+     * which is not the one in .debug_info, so split DWARF has none.
+     */
+    debug_pubnames_buf = NULL;
+    if (!dwarf_split())
+    {
+        seg = dwarf_getsegment(debug_pubnames, 0);
+        debug_pubnames_secidx = SegData[seg]->SDshtidx;
+        debug_pubnames_buf = SegData[seg]->SDbuf;
+        debug_pubnames_buf->reserve(1000);
 
-    debug_pubnames_buf->write32(0);             // unit_length
-    debug_pubnames_buf->writeWord(2);           // version
+        debug_pubnames_buf->write32(0);             // unit_length
+        debug_pubnames_buf->writeWord(2);           // version
 #if ELFOBJ
-    dwarf_addrel(seg,debug_pubnames_buf->size(),infoseg);
+        dwarf_addrel(seg,debug_pubnames_buf->size(),infoseg);
 #endif
-    debug_pubnames_buf->write32(0);             // debug_info_offset
-    debug_pubnames_buf->write32(0);             // debug_info_length
+        debug_pubnames_buf->write32(0);             // debug_info_offset
+        debug_pubnames_buf->write32(0);             // debug_info_length
+    }
 
     /* ======================================== */
 
@@ -1186,7 +1355,7 @@ void dwarf_initfile(const char *filename)
 int dwarf_line_addfile(const char* filename)
 {
     if (!infoFileName_table) {
-        infoFileName_table = new AArray(&ti_abuf, sizeof(unsigned));
+        infoFileName_table = new HashTab<Abuf, unsigned, AbufTraits>();
         linebuf_filetab_end = linebuf->size();
     }
 
@@ -1194,7 +1363,7 @@ int dwarf_line_addfile(const char* filename)
     abuf.buf = (const unsigned char*)filename;
     abuf.length = strlen(filename);
 
-    unsigned *pidx = (unsigned *)infoFileName_table->get(&abuf);
+    unsigned *pidx = infoFileName_table->get(abuf);
     if (!*pidx)                 // if no idx assigned yet
     {
         *pidx = infoFileName_table->length(); // assign newly computed idx
@@ -1245,7 +1414,7 @@ void dwarf_termmodule()
  * Finish writing Dwarf debug info to object file.
  */
 
-void dwarf_termfile()
+void dwarf_termfile(const char *objfilename)
 {
     //printf("dwarf_termfile()\n");
 
@@ -1396,14 +1565,20 @@ void dwarf_termfile()
     debuginfo.total_length = infobuf->size() - 4;
     memcpy(infobuf->buf, &debuginfo, sizeof(debuginfo));
 
+    if (dwarf_split())
+        dwarf_termdwo(objfilename);
+
     /* ================================================= */
 
-    // Terminate by offset field containing 0
-    debug_pubnames_buf->write32(0);
+    if (debug_pubnames_buf)
+    {
+        // Terminate by offset field containing 0
+        debug_pubnames_buf->write32(0);
 
-    // Plug final sizes into header
-    *(unsigned *)debug_pubnames_buf->buf = debug_pubnames_buf->size() - 4;
-    *(unsigned *)(debug_pubnames_buf->buf + 10) = infobuf->size();
+        // Plug final sizes into header
+        *(unsigned *)debug_pubnames_buf->buf = debug_pubnames_buf->size() - 4;
+        *(unsigned *)(debug_pubnames_buf->buf + 10) = infobuf->size();
+    }
 
     /* ================================================= */
 
@@ -1435,6 +1610,65 @@ void dwarf_termfile()
         functypebuf->setsize(0);
 }
 
+/*****************************************
+ * Write the .dwo file for objfilename, and the skeleton compile unit
+ * that points to it.
+ */
+
+static void dwarf_termdwo(const char *objfilename)
+{
+#if ELFOBJ
+    char *dwoname = filespecforceext(objfilename, "dwo");
+
+    /* Identify the .dwo file by a hash of its compile unit, so a debugger
+     * can tell it doesn't go with the object file anymore.
+     */
+    unsigned long long dwo_id = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < infobuf->size(); i++)
+        dwo_id = (dwo_id ^ infobuf->buf[i]) * 0x100000001B3ULL;   // 64 bit FNV-1a
+    memcpy(infobuf->buf + dwo_id_offset, &dwo_id, sizeof(dwo_id));
+
+    Outbuffer *buf = SegData[abbrevseg]->SDbuf;
+    buf->writeByte(1);                          // abbreviation code
+    buf->writeByte(DW_TAG_compile_unit);
+    buf->writeByte(0);                          // no children
+    buf->writeuLEB128(DW_AT_GNU_dwo_name);      buf->writeByte(DW_FORM_string);
+    buf->writeByte(DW_AT_comp_dir);             buf->writeByte(DW_FORM_string);
+    buf->writeuLEB128(DW_AT_GNU_dwo_id);        buf->writeByte(DW_FORM_data8);
+    buf->writeByte(DW_AT_low_pc);               buf->writeByte(DW_FORM_addr);
+    buf->writeByte(DW_AT_ranges);               buf->writeByte(DW_FORM_sec_offset);
+    buf->writeByte(DW_AT_stmt_list);            buf->writeByte(DW_FORM_sec_offset);
+    buf->writeuLEB128(DW_AT_GNU_addr_base);     buf->writeByte(DW_FORM_sec_offset);
+    buf->writeByte(0);                          buf->writeByte(0);
+    buf->writeByte(0);                          // end of abbreviations
+
+    buf = SegData[infoseg]->SDbuf;
+    DebugInfoHeader skeleton = debuginfo;
+    buf->write(&skeleton, sizeof(skeleton));
+    dwarf_addrel(infoseg,6,abbrevseg);
+    buf->writeuLEB128(1);                       // abbreviation code
+    buf->writeString(dwoname);                  // DW_AT_GNU_dwo_name
+    buf->writeString(comp_dir);                 // DW_AT_comp_dir
+    buf->write64(dwo_id);                       // DW_AT_GNU_dwo_id
+    append_addr(buf, 0);                        // DW_AT_low_pc
+    dwarf_addrel(infoseg,buf->size(),debug_ranges_seg);
+    buf->write32(0);                            // DW_AT_ranges
+    dwarf_addrel(infoseg,buf->size(),lineseg);
+    buf->write32(0);                            // DW_AT_stmt_list
+    dwarf_addrel(infoseg,buf->size(),debug_addr_seg);
+    buf->write32(0);                            // DW_AT_GNU_addr_base
+    skeleton.total_length = buf->size() - 4;
+    memcpy(buf->buf, &skeleton, sizeof(skeleton));
+
+    const char *names[3] = { ".debug_info.dwo", ".debug_abbrev.dwo", ".debug_loc.dwo" };
+    Outbuffer *bufs[3] = { dwo_infobuf, dwo_abbrevbuf, dwo_locbuf };
+    ElfObj::writedwo(dwoname, 3, names, bufs);
+    mem_free(dwoname);
+#else
+    assert(0);
+#endif
+}
+
 /*****************************************
  * Start of code gen for function.
  */
@@ -1565,9 +1799,17 @@ void dwarf_func_term(Symbol *sfunc)
         {
             abuf.writeByte(DW_AT_external);       abuf.writeByte(DW_FORM_flag);
         }
-        abuf.writeByte(DW_AT_low_pc);     abuf.writeByte(DW_FORM_addr);
-        abuf.writeByte(DW_AT_high_pc);    abuf.writeByte(DW_FORM_addr);
-        abuf.writeByte(DW_AT_frame_base); abuf.writeByte(DW_FORM_data4);
+        if (dwarf_split())
+        {
+            abuf.writeByte(DW_AT_low_pc);     abuf.writeuLEB128(DW_FORM_GNU_addr_index);
+            abuf.writeByte(DW_AT_high_pc);    abuf.writeByte(DW_FORM_data4);    // length
+        }
+        else
+        {
+            abuf.writeByte(DW_AT_low_pc);     abuf.writeByte(DW_FORM_addr);
+            abuf.writeByte(DW_AT_high_pc);    abuf.writeByte(DW_FORM_addr);
+        }
+        abuf.writeByte(DW_AT_frame_base); abuf.writeByte(dwarf_secoffset_form());
         abuf.writeByte(0);                abuf.writeByte(0);
 
         funcabbrevcode = dwarf_abbrev_code(abuf.buf, abuf.size());
@@ -1600,12 +1842,25 @@ void dwarf_func_term(Symbol *sfunc)
             infobuf->writeByte(1);              // DW_AT_external
 
         // DW_AT_low_pc and DW_AT_high_pc
-        dwarf_appreladdr(infoseg, infobuf, seg, funcoffset);
-        dwarf_appreladdr(infoseg, infobuf, seg, funcoffset + sfunc->Ssize);
+        unsigned funcaddr_index;
+        if (dwarf_split())
+        {
+            funcaddr_index = dwarf_addr_index(seg, funcoffset);
+            infobuf->writeuLEB128(funcaddr_index);
+            infobuf->write32(sfunc->Ssize);
+        }
+        else
+        {
+            dwarf_appreladdr(infoseg, infobuf, seg, funcoffset);
+            dwarf_appreladdr(infoseg, infobuf, seg, funcoffset + sfunc->Ssize);
+        }
 
         // DW_AT_frame_base
 #if ELFOBJ
-        dwarf_apprel32(infoseg, infobuf, debug_loc_seg, debug_loc_buf->size());
+        if (dwarf_split())
+            infobuf->write32(debug_loc_buf->size());    // no relocation in .dwo
+        else
+            dwarf_apprel32(infoseg, infobuf, debug_loc_seg, debug_loc_buf->size());
 #else
         // 64-bit DWARF relocations don't work for OSX64 codegen
         infobuf->write32(debug_loc_buf->size());
@@ -1705,9 +1960,12 @@ void dwarf_func_term(Symbol *sfunc)
 
         /* ============= debug_pubnames =========================== */
 
-        debug_pubnames_buf->write32(infobuf_offset);
-        // Should be the fully qualified name, not the simple DW_AT_name
-        debug_pubnames_buf->writeString(sfunc->Sident);
+        if (debug_pubnames_buf)
+        {
+            debug_pubnames_buf->write32(infobuf_offset);
+            // Should be the fully qualified name, not the simple DW_AT_name
+            debug_pubnames_buf->writeString(sfunc->Sident);
+        }
 
         /* ============= debug_aranges =========================== */
 
@@ -1739,6 +1997,27 @@ void dwarf_func_term(Symbol *sfunc)
         unsigned short op_size = 0x0002;
         unsigned short loc_op;
 
+        if (dwarf_split())
+        {   // Same list in the .debug_loc.dwo format, with address indices
+            unsigned loc_ops[3] =
+            {
+                (unsigned)(((Para.size - REGSIZE) << 8) | (DW_OP_breg0 + dwarf_regno(SP))),  // after call
+                (unsigned)(((Para.size) << 8) | (DW_OP_breg0 + dwarf_regno(SP))),            // after push EBP
+                (unsigned)(((Para.size) << 8) | (DW_OP_breg0 + dwarf_regno(BP))),            // after mov EBP, ESP
+            };
+            targ_size_t starts[4] = { 0, 1, 3, sfunc->Ssize };
+            for (int i = 0; i < 3; i++)
+            {
+                debug_loc_buf->writeByte(DW_LLE_GNU_start_length_entry);
+                debug_loc_buf->writeuLEB128(i ? dwarf_addr_index(seg, funcoffset + starts[i])
+                                              : funcaddr_index);
+                debug_loc_buf->write32(starts[i + 1] - starts[i]);
+                debug_loc_buf->write32(loc_ops[i] << 16 | op_size);
+            }
+            debug_loc_buf->writeByte(DW_LLE_GNU_end_of_list_entry);
+            return;
+        }
+
         // set the entry for this function in .debug_loc segment
         // after call
         dwarf_appreladdr(debug_loc_seg, debug_loc_buf, seg, funcoffset + 0);
@@ -1818,7 +2097,15 @@ void cv_outsym(symbol *s)
             assert(s->Sxtrnnum);
             if (s->Sfl == FLtlsdata)
             {
-                if (I64)
+                if (dwarf_split())
+                {   // The offset goes in .debug_addr
+                    infobuf->writeByte(DW_OP_GNU_const_index);
+                    infobuf->writeuLEB128(debug_addr_buf->size() / (I64 ? 8 : 4));
+                    ElfObj::addrel(debug_addr_seg, debug_addr_buf->size(),
+                        I64 ? R_X86_64_DTPOFF32 : R_386_TLS_LDO_32, s->Sxtrnnum, 0);
+                    append_addr(debug_addr_buf, 0);
+                }
+                else if (I64)
                 {
                     infobuf->writeByte(DW_OP_const8u);
                     ElfObj::addrel(infoseg, infobuf->size(), R_X86_64_DTPOFF32, s->Sxtrnnum, 0);
@@ -1833,6 +2120,12 @@ void cv_outsym(symbol *s)
                 infobuf->writeByte(DW_OP_GNU_push_tls_address);
             } else
 #endif
+            if (dwarf_split())
+            {
+                infobuf->writeByte(DW_OP_GNU_addr_index);
+                infobuf->writeuLEB128(dwarf_addr_index(s->Sseg, s->Soffset)); // address of global
+            }
+            else
             {
                 infobuf->writeByte(DW_OP_addr);
                 dwarf_appreladdr(infoseg, infobuf, s->Sseg, s->Soffset); // address of global
@@ -1861,87 +2154,207 @@ void cv_func(Funcsym *s)
 {
 }
 
-/* =================== Cached Types in debug_info ================= */
-
-struct Atype
+unsigned char dwarf_classify_struct(unsigned long sflags)
 {
-    Outbuffer *buf;
-    size_t start;
-    size_t end;
-};
+    if (sflags & STRclass)
+        return DW_TAG_class_type;
 
-struct TypeInfo_Atype : TypeInfo
-{
-    const char* toString();
-    hash_t getHash(void *p);
-    int equals(void *p1, void *p2);
-    int compare(void *p1, void *p2);
-    size_t tsize();
-    void swap(void *p1, void *p2);
-};
+    if (sflags & STRunion)
+        return DW_TAG_union_type;
+
+    return DW_TAG_structure_type;
+}
 
-TypeInfo_Atype ti_atype;
+/* ======================= Type Units ============================== */
 
-const char* TypeInfo_Atype::toString()
+struct Fnv
 {
-    return "Atype";
-}
+    unsigned long long hash;
 
-hash_t TypeInfo_Atype::getHash(void *p)
-{   Atype a;
-    hash_t hash = 0;
-    size_t i;
+    Fnv() : hash(0xCBF29CE484222325ULL) { }
 
-    a = *(Atype *)p;
-    for (i = a.start; i < a.end; i++)
+    void add(const void *p, size_t length)
     {
-        hash = hash * 11 + a.buf->buf[i];
+        // 64 bit FNV-1a
+        for (size_t i = 0; i < length; i++)
+            hash = (hash ^ ((const unsigned char *)p)[i]) * 0x100000001B3ULL;
     }
-    return hash;
-}
+};
 
-int TypeInfo_Atype::equals(void *p1, void *p2)
+/*****************************************
+ * Add type t of a field to the type signature being computed.
+ * Structs and enums are added by name only, which also ends the
+ * recursion for structs that point to themselves.
+ */
+
+static void dwarf_typesig_type(Fnv *fnv, type *t)
 {
-    Atype a1 = *(Atype*)p1;
-    Atype a2 = *(Atype*)p2;
-    size_t len = a1.end - a1.start;
+    if (!t)
+    {   tym_t ty = 0;
+        fnv->add(&ty, sizeof(ty));
+        return;
+    }
+    tym_t ty = t->Tty;
+    fnv->add(&ty, sizeof(ty));
+    switch (tybasic(ty))
+    {
+        case TYstruct:
+        case TYenum:
+            fnv->add(t->Ttag->Sident, strlen(t->Ttag->Sident) + 1);
+            return;
 
-    return len == a2.end - a2.start &&
-        memcmp(a1.buf->buf + a1.start, a2.buf->buf + a2.start, len) == 0;
-}
+        case TYarray:
+            if (!(t->Tflags & TFvla))
+                fnv->add(&t->Tdim, sizeof(t->Tdim));
+            break;
 
-int TypeInfo_Atype::compare(void *p1, void *p2)
-{
-    Atype a1 = *(Atype*)p1;
-    Atype a2 = *(Atype*)p2;
-    size_t len = a1.end - a1.start;
-    if (len == a2.end - a2.start)
-        return memcmp(a1.buf->buf + a1.start, a2.buf->buf + a2.start, len);
-    else if (len < a2.end - a2.start)
-        return -1;
-    else
-        return 1;
+        case TYnptr:
+            if (t->Tkey)                        // associative array
+                dwarf_typesig_type(fnv, t->Tkey);
+            break;
+
+        default:
+            if (tyfunc(ty))
+            {
+                for (param_t *p = t->Tparamtypes; p; p = p->Pnext)
+                    dwarf_typesig_type(fnv, p->Ptype);
+            }
+            break;
+    }
+    dwarf_typesig_type(fnv, t->Tnext);
 }
 
-size_t TypeInfo_Atype::tsize()
+/*****************************************
+ * Compute the type signature of a struct from its name, size and fields,
+ * so every object file comes up with the same one for it.
+ * The field types are part of it, as structs local to overloaded
+ * functions can have the same name and layout.
+ */
+
+static unsigned long long dwarf_typesig(Classsym *s)
 {
-    return sizeof(Atype);
+    Fnv fnv;
+    struct_t *st = s->Sstruct;
+    unsigned char tag = dwarf_classify_struct(st->Sflags);
+    fnv.add(&tag, 1);
+    fnv.add(s->Sident, strlen(s->Sident) + 1);
+    unsigned size = st->Sstructsize;
+    fnv.add(&size, sizeof(size));
+    for (symlist_t sl = st->Sfldlst; sl; sl = list_next(sl))
+    {   symbol *sf = list_symbol(sl);
+
+        if (sf->Sclass == SCmember)
+        {
+            fnv.add(sf->Sident, strlen(sf->Sident) + 1);
+            unsigned memoff = sf->Smemoff;
+            fnv.add(&memoff, sizeof(memoff));
+            dwarf_typesig_type(&fnv, sf->Stype);
+        }
+    }
+    return fnv.hash;
 }
 
-void TypeInfo_Atype::swap(void *p1, void *p2)
+/*****************************************
+ * Write the type unit for struct type t in a COMDAT .debug_types section.
+ * The state of the compile unit is saved and restored around it, as
+ * the type unit has its own type indices.
+ */
+
+static void dwarf_typeunit_write(type *t, unsigned long long sig)
 {
+#if ELFOBJ
+    //printf("dwarf_typeunit_write(%s)\n", t->Ttag->Sident);
+    char signame[3 + 16 + 1];
+    sprintf(signame, "wt.%016llx", sig);
+    int seg = ElfObj::getgroupsegment(".debug_types", signame, SHT_PROGBITS, 0, 1);
+
+    Outbuffer *cuinfobuf = infobuf;
+    unsigned cutypidx_tab[TYMAX];
+    memcpy(cutypidx_tab, typidx_tab, sizeof(typidx_tab));
+    HashTab<Atype, unsigned, AtypeTraits> *cutype_table = type_table;
+    HashTab<Atype, unsigned, AtypeTraits> *cufunctype_table = functype_table;
+
+    infobuf = SegData[seg]->SDbuf;
+    memset(typidx_tab, 0, sizeof(typidx_tab));
+    type_table = NULL;
+    functype_table = NULL;
+    typeunit_sym = t->Ttag;
+
+    DebugTypesHeader header;
+    header.total_length = 0;
+    header.version = 4;
+    header.abbrev_offset = 0;
+    header.address_size = debuginfo.address_size;
+    header.signature = sig;
+    header.type_offset = 0;
+    infobuf->write(&header, sizeof(header));
+    dwarf_addrel(seg,6,abbrevseg);
+
+    static unsigned char abbrevTypeUnit[] =
+    {
+        DW_TAG_type_unit,
+        1,                      // children
+        DW_AT_language,         DW_FORM_data1,
+        0,                      0,
+    };
+    infobuf->writeuLEB128(dwarf_abbrev_code(abbrevTypeUnit, sizeof(abbrevTypeUnit)));
+#if MARS
+    infobuf->writeByte((config.fulltypes == CVDWARF_D) ? DW_LANG_D : DW_LANG_C89);
+#else
+    infobuf->writeByte(DW_LANG_C89);            // DW_AT_language
+#endif
+
+    header.type_offset = dwarf_typidx(t);
+    infobuf->writeByte(0);                      // end of DW_TAG_type_unit's children
+
+    header.total_length = infobuf->size() - 4;
+    memcpy(infobuf->buf, &header, sizeof(header));
+
+    delete type_table;
+    delete functype_table;
+    infobuf = cuinfobuf;
+    memcpy(typidx_tab, cutypidx_tab, sizeof(typidx_tab));
+    type_table = cutype_table;
+    functype_table = cufunctype_table;
+    typeunit_sym = NULL;
+#else
     assert(0);
+#endif
 }
 
-unsigned char dwarf_classify_struct(unsigned long sflags)
+/*****************************************
+ * Get the signature of the type unit for struct type t, and queue
+ * the type unit to be written if it's the first time in this object file.
+ * Type units are not written from inside another one, as that would
+ * need nesting the save/restore of the type indices.
+ */
+
+static unsigned long long dwarf_typeunit(type *t)
 {
-    if (sflags & STRclass)
-        return DW_TAG_class_type;
+    unsigned long long sig = dwarf_typesig(t->Ttag);
 
-    if (sflags & STRunion)
-        return DW_TAG_union_type;
+    if (!typeunit_table)
+        typeunit_table = new HashTab<unsigned long long, int, TypesigTraits>();
+    int *pdone = typeunit_table->get(sig);
+    if (!*pdone)
+    {
+        *pdone = 1;
+        if (!typeunit_pending)
+            typeunit_pending = new Outbuffer();
+        typeunit_pending->write(&t, sizeof(t));
+    }
 
-    return DW_TAG_structure_type;
+    if (!typeunit_sym)
+    {
+        while (typeunit_pending->size())
+        {
+            size_t n = typeunit_pending->size() - sizeof(type *);
+            type *tp = *(type **)(typeunit_pending->buf + n);
+            typeunit_pending->setsize(n);
+            dwarf_typeunit_write(tp, dwarf_typesig(tp->Ttag));
+        }
+    }
+    return sig;
 }
 
 /* ======================= Type Index ============================== */
@@ -2329,12 +2742,12 @@ unsigned dwarf_typidx(type *t)
             /* If it's in the cache already, return the existing typidx
              */
             if (!functype_table)
-                functype_table = new AArray(&ti_atype, sizeof(unsigned));
+                functype_table = new HashTab<Atype, unsigned, AtypeTraits>();
             Atype functype;
             functype.buf = functypebuf;
             functype.start = functypebufidx;
             functype.end = functypebuf->size();
-            unsigned *pidx = (unsigned *)functype_table->get(&functype);
+            unsigned *pidx = functype_table->get(functype);
             if (*pidx)
             {   // Reuse existing typidx
                 functypebuf->setsize(functypebufidx);
@@ -2510,7 +2923,7 @@ unsigned dwarf_typidx(type *t)
             Classsym *s = t->Ttag;
             struct_t *st = s->Sstruct;
 
-            if (s->Stypidx)
+            if (s->Stypidx && !typeunit_sym)
                 return s->Stypidx;
 
             static unsigned char abbrevTypeStruct0[] =
@@ -2530,6 +2943,31 @@ unsigned dwarf_typidx(type *t)
                 0,                      0,
             };
 
+            if (dwarf_typeunits() && !(t->Tflags & TFsizeunknown) &&
+                (s != typeunit_sym || t->Tflags & TFforward))
+            {   // Refer to the struct's type unit
+                static unsigned char abbrevTypeStructSig[] =
+                {
+                    DW_TAG_structure_type,
+                    0,                      // no children
+                    DW_AT_declaration,      DW_FORM_flag,
+                    DW_AT_signature,        DW_FORM_ref_sig8,
+                    0,                      0,
+                };
+                abbrevTypeStructSig[0] = dwarf_classify_struct(st->Sflags);
+                unsigned long long sig = dwarf_typeunit(t);
+                code = dwarf_abbrev_code(abbrevTypeStructSig, sizeof(abbrevTypeStructSig));
+                idx = infobuf->size();
+                infobuf->writeuLEB128(code);
+                infobuf->writeByte(1);                  // DW_AT_declaration
+                infobuf->write64(sig);                  // DW_AT_signature
+                if (typeunit_sym)
+                    break;              // Stypidx is for the compile unit
+                s->Stypidx = idx;
+                reset_symbuf->write(&s, sizeof(s));
+                return idx;
+            }
+
             if (t->Tflags & (TFsizeunknown | TFforward))
             {
                 abbrevTypeStruct1[0] = dwarf_classify_struct(st->Sflags);
@@ -2613,7 +3051,8 @@ unsigned dwarf_typidx(type *t)
                 else
                     infobuf->write32(sz);       // DW_AT_byte_size
 
-                s->Stypidx = idx;
+                if (!typeunit_sym)
+                    s->Stypidx = idx;
                 unsigned n = 0;
                 for (sl = st->Sfldlst; sl; sl = list_next(sl))
                 {   symbol *sf = list_symbol(sl);
@@ -2639,6 +3078,8 @@ unsigned dwarf_typidx(type *t)
 
                 infobuf->writeByte(0);          // no more children
             }
+            if (typeunit_sym)
+                return idx;
             s->Stypidx = idx;
             reset_symbuf->write(&s, sizeof(s));
             return idx;                 // no need to cache it
@@ -2668,7 +3109,7 @@ unsigned dwarf_typidx(type *t)
             unsigned sz = type_size(tbase);
             symlist_t sl;
 
-            if (s->Stypidx)
+            if (s->Stypidx && !typeunit_sym)
                 return s->Stypidx;
 
             if (se->SEflags & SENforward)
@@ -2727,6 +3168,8 @@ unsigned dwarf_typidx(type *t)
 
             infobuf->writeByte(0);              // no more children
 
+            if (typeunit_sym)
+                break;                  // Stypidx is for the compile unit
             s->Stypidx = idx;
             reset_symbuf->write(&s, sizeof(s));
             return idx;                 // no need to cache it
@@ -2748,10 +3191,10 @@ Lret:
         /* unsigned[Adata] type_table;
          * where the table values are the type indices
          */
-        type_table = new AArray(&ti_atype, sizeof(unsigned));
+        type_table = new HashTab<Atype, unsigned, AtypeTraits>();
 
     unsigned *pidx;
-    pidx = (unsigned *)type_table->get(&atype);
+    pidx = type_table->get(atype);
     if (!*pidx)                 // if no idx assigned yet
     {
         *pidx = idx;            // assign newly computed idx
@@ -2766,85 +3209,13 @@ Lret:
 
 /* ======================= Abbreviation Codes ====================== */
 
-struct Adata
-{
-    size_t start;
-    size_t end;
-};
-
-struct TypeInfo_Adata : TypeInfo
-{
-    const char* toString();
-    hash_t getHash(void *p);
-    int equals(void *p1, void *p2);
-    int compare(void *p1, void *p2);
-    size_t tsize();
-    void swap(void *p1, void *p2);
-};
-
-TypeInfo_Adata ti_adata;
-
-const char* TypeInfo_Adata::toString()
-{
-    return "Adata";
-}
-
-hash_t TypeInfo_Adata::getHash(void *p)
-{   Adata a;
-    hash_t hash = 0;
-    size_t i;
-
-    a = *(Adata *)p;
-    for (i = a.start; i < a.end; i++)
-    {
-        //printf("%02x ", abbrevbuf->buf[i]);
-        hash = hash * 11 + abbrevbuf->buf[i];
-    }
-    //printf("\nhash = %x, length = %d\n", hash, a.end - a.start);
-    return hash;
-}
-
-int TypeInfo_Adata::equals(void *p1, void *p2)
-{
-    Adata a1 = *(Adata*)p1;
-    Adata a2 = *(Adata*)p2;
-    size_t len = a1.end - a1.start;
-
-    return len == a2.end - a2.start &&
-        memcmp(abbrevbuf->buf + a1.start, abbrevbuf->buf + a2.start, len) == 0;
-}
-
-int TypeInfo_Adata::compare(void *p1, void *p2)
-{
-    Adata a1 = *(Adata*)p1;
-    Adata a2 = *(Adata*)p2;
-    size_t len = a1.end - a1.start;
-    if (len == a2.end - a2.start)
-        return memcmp(abbrevbuf->buf + a1.start, abbrevbuf->buf + a2.start, len);
-    else if (len < a2.end - a2.start)
-        return -1;
-    else
-        return 1;
-}
-
-size_t TypeInfo_Adata::tsize()
-{
-    return sizeof(Adata);
-}
-
-void TypeInfo_Adata::swap(void *p1, void *p2)
-{
-    assert(0);
-}
-
-
 unsigned dwarf_abbrev_code(unsigned char *data, size_t nbytes)
 {
     if (!abbrev_table)
         /* unsigned[Adata] abbrev_table;
          * where the table values are the abbreviation codes.
          */
-        abbrev_table = new AArray(&ti_adata, sizeof(unsigned));
+        abbrev_table = new HashTab<Adata, unsigned, AdataTraits>();
 
     /* Write new entry into abbrevbuf
      */
@@ -2862,7 +3233,7 @@ unsigned dwarf_abbrev_code(unsigned char *data, size_t nbytes)
      */
 
     unsigned *pcode;
-    pcode = (unsigned *)abbrev_table->get(&adata);
+    pcode = abbrev_table->get(adata);
     if (!*pcode)                // if no code assigned yet
     {
         *pcode = abbrevcode;    // assign newly computed code
@@ -7,7 +7,7 @@
 #define DWARF_VERSION 3
 
 void dwarf_initfile(const char *filename);
-void dwarf_termfile();
+void dwarf_termfile(const char *objfilename);
 void dwarf_initmodule(const char *filename, const char *modulename);
 void dwarf_termmodule();
 void dwarf_func_start(Symbol *sfunc);
@@ -182,6 +182,13 @@ enum
         DW_AT_lo_user                   = 0x2000,
         DW_AT_MIPS_linkage_name         = 0x2007,
         DW_AT_GNU_vector                = 0x2107,
+
+        /* GNU split DWARF */
+        DW_AT_GNU_dwo_name              = 0x2130,
+        DW_AT_GNU_dwo_id                = 0x2131,
+        DW_AT_GNU_ranges_base           = 0x2132,
+        DW_AT_GNU_addr_base             = 0x2133,
+        DW_AT_GNU_pubnames              = 0x2134,
         DW_AT_hi_user                   = 0x3FFF,
 };
 
@@ -214,6 +221,10 @@ enum
         DW_FORM_exprloc      = 0x18,
         DW_FORM_flag_present = 0x19,
         DW_FORM_ref_sig8     = 0x20,
+
+        /* GNU split DWARF */
+        DW_FORM_GNU_addr_index = 0x1f01,
+        DW_FORM_GNU_str_index  = 0x1f02,
 };
 
 enum
@@ -296,6 +307,18 @@ enum
 
         /* GNU extensions. */
         DW_OP_GNU_push_tls_address = 0xe0,
+        DW_OP_GNU_addr_index    = 0xfb,
+        DW_OP_GNU_const_index   = 0xfc,
+};
+
+/* GNU split DWARF location list entries in .debug_loc.dwo
+ */
+enum
+{
+        DW_LLE_GNU_end_of_list_entry    = 0,
+        DW_LLE_GNU_base_address_selection_entry = 1,
+        DW_LLE_GNU_start_end_entry      = 2,
+        DW_LLE_GNU_start_length_entry   = 3,
 };
 
 enum
@@ -40,6 +40,7 @@ struct elem
                                 // always 0 until CSE elimination is done
     unsigned char Eflags;
     #define EFLAGS_variadic 1   // variadic function call
+    #define EFLAGS_arraybounds 2 // (index < length || bounds error) array bounds check
 
     union eve EV;               // variants for each type of elem
     union
@@ -142,6 +143,7 @@ elem_p el_scancommas(elem_p);
 int el_countCommas(elem_p);
 int el_sideeffect(elem_p);
 int el_depends(elem *ea,elem *eb);
+int el_anyframeptr(elem *e);
 targ_llong el_tolongt(elem_p);
 targ_llong el_tolong(elem_p);
 int el_allbits(elem_p,int);
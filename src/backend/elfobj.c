@@ -38,7 +38,7 @@
 
 #include        "dwarf.h"
 
-#include        "aa.h"
+#include        "hashtab.h"
 #include        "tinfo.h"
 
 #ifndef ELFOSABI
@@ -116,6 +116,7 @@ void Obj::refGOTsym()
 }
 
 static void objfile_write(FILE *fd, void *buffer, unsigned len);
+static void objfile_flush(FILE *fd);
 
 STATIC char * objmodtoseg (const char *modname);
 STATIC void objfixupp (struct FIXUP *);
@@ -129,6 +130,8 @@ static IDXSYM elf_addsym(IDXSTR sym, targ_size_t val, unsigned sz,
                          unsigned typ,unsigned bind,IDXSEC sec,
                          unsigned char visibility=STV_DEFAULT);
 static long elf_align(targ_size_t size, long offset);
+static bool elf_iscompressed(Elf32_Shdr *sechdr, seg_data *pseg);
+static size_t elf_writecompressed(Outbuffer *data, unsigned addralign);
 
 // The object file is built is several separate pieces
 
@@ -146,70 +149,33 @@ static Outbuffer *section_names;
 #define SEC_NAMES_INIT  800
 #define SEC_NAMES_INC   400
 
-// Hash table for section_names
-AArray *section_names_hashtable;
-
 /* ====================== Cached Strings in section_names ================= */
 
-struct TypeInfo_Idxstr : TypeInfo
-{
-    const char* toString();
-    hash_t getHash(void *p);
-    int equals(void *p1, void *p2);
-    int compare(void *p1, void *p2);
-    size_t tsize();
-    void swap(void *p1, void *p2);
-};
-
-TypeInfo_Idxstr ti_idxstr;
-
-const char* TypeInfo_Idxstr::toString()
+struct IdxstrTraits
 {
-    return "IDXSTR";
-}
-
-hash_t TypeInfo_Idxstr::getHash(void *p)
-{
-    IDXSTR a = *(IDXSTR *)p;
-    hash_t hash = 0;
-    for (const char *s = (char *)(section_names->buf + a);
-         *s;
-         s++)
+    static hash_t hash(const IDXSTR& a)
     {
-        hash = hash * 11 + *s;
+        hash_t hash = 0;
+        for (const char *s = (char *)(section_names->buf + a);
+             *s;
+             s++)
+        {
+            hash = hash * 11 + *s;
+        }
+        return hash;
     }
-    return hash;
-}
-
-int TypeInfo_Idxstr::equals(void *p1, void *p2)
-{
-    IDXSTR a1 = *(IDXSTR*)p1;
-    IDXSTR a2 = *(IDXSTR*)p2;
-    const char *s1 = (char *)(section_names->buf + a1);
-    const char *s2 = (char *)(section_names->buf + a2);
 
-    return strcmp(s1, s2) == 0;
-}
-
-int TypeInfo_Idxstr::compare(void *p1, void *p2)
-{
-    IDXSTR a1 = *(IDXSTR*)p1;
-    IDXSTR a2 = *(IDXSTR*)p2;
-    const char *s1 = (char *)(section_names->buf + a1);
-    const char *s2 = (char *)(section_names->buf + a2);
-
-    return strcmp(s1, s2);
-}
+    static bool equals(const IDXSTR& a1, const IDXSTR& a2)
+    {
+        const char *s1 = (char *)(section_names->buf + a1);
+        const char *s2 = (char *)(section_names->buf + a2);
 
-size_t TypeInfo_Idxstr::tsize()
-{
-    return sizeof(IDXSTR);
-}
+        return strcmp(s1, s2) == 0;
+    }
+};
 
-void TypeInfo_Idxstr::swap(void *p1, void *p2)
-{
-    assert(0);
-}
+// Hash table for section_names
+static HashTab<IDXSTR, IDXSTR, IdxstrTraits> *section_names_hashtable;
 
 
 /* ======================================================================== */
@@ -603,7 +569,7 @@ static IDXSEC elf_newsection(const char *name, const char *suffix,
         section_names->setsize(section_names->size() - 1);  // back up over terminating 0
         section_names->writeString(suffix);
     }
-    IDXSTR *pidx = (IDXSTR *)section_names_hashtable->get(&namidx);
+    IDXSTR *pidx = section_names_hashtable->get(namidx);
     assert(!*pidx);             // must not already exist
     *pidx = namidx;
 
@@ -733,7 +699,7 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
 
         if (section_names_hashtable)
             delete section_names_hashtable;
-        section_names_hashtable = new AArray(&ti_idxstr, sizeof(IDXSTR));
+        section_names_hashtable = new HashTab<IDXSTR, IDXSTR, IdxstrTraits>();
 
         // name,type,flags,addr,offset,size,link,info,addralign,entsize
         elf_newsection2(0,               SHT_NULL,   0,                 0,0,0,0,0, 0,0);
@@ -752,19 +718,19 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
         elf_newsection2(NAMIDX_CDATAREL,SHT_PROGBITS,SHF_ALLOC|SHF_WRITE,0,0,0,0,0, 16,0);
 
         IDXSTR namidx;
-        namidx = NAMIDX_TEXT;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RELTEXT;   *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_DATA;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RELDATA64; *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_BSS;       *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RODATA;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_STRTAB;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_SYMTAB;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_SHSTRTAB;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_COMMENT;   *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_NOTE;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_GNUSTACK;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_CDATAREL;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
+        namidx = NAMIDX_TEXT;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RELTEXT;   *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_DATA;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RELDATA64; *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_BSS;       *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RODATA;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_STRTAB;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_SYMTAB;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_SHSTRTAB;  *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_COMMENT;   *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_NOTE;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_GNUSTACK;  *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_CDATAREL;  *section_names_hashtable->get(namidx) = namidx;
     }
     else
     {
@@ -781,7 +747,7 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
 
         if (section_names_hashtable)
             delete section_names_hashtable;
-        section_names_hashtable = new AArray(&ti_idxstr, sizeof(IDXSTR));
+        section_names_hashtable = new HashTab<IDXSTR, IDXSTR, IdxstrTraits>();
 
         // name,type,flags,addr,offset,size,link,info,addralign,entsize
         elf_newsection2(0,               SHT_NULL,   0,                 0,0,0,0,0, 0,0);
@@ -800,19 +766,19 @@ Obj *Obj::init(Outbuffer *objbuf, const char *filename, const char *csegname)
         elf_newsection2(NAMIDX_CDATAREL,SHT_PROGBITS,SHF_ALLOC|SHF_WRITE,0,0,0,0,0, 1,0);
 
         IDXSTR namidx;
-        namidx = NAMIDX_TEXT;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RELTEXT;   *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_DATA;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RELDATA;   *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_BSS;       *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_RODATA;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_STRTAB;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_SYMTAB;    *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_SHSTRTAB;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_COMMENT;   *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_NOTE;      *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_GNUSTACK;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
-        namidx = NAMIDX_CDATAREL;  *(IDXSTR *)section_names_hashtable->get(&namidx) = namidx;
+        namidx = NAMIDX_TEXT;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RELTEXT;   *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_DATA;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RELDATA;   *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_BSS;       *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_RODATA;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_STRTAB;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_SYMTAB;    *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_SHSTRTAB;  *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_COMMENT;   *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_NOTE;      *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_GNUSTACK;  *section_names_hashtable->get(namidx) = namidx;
+        namidx = NAMIDX_CDATAREL;  *section_names_hashtable->get(namidx) = namidx;
     }
 
     if (SYMbuf)
@@ -1070,7 +1036,21 @@ void Obj::termfile()
 
 void Obj::term(const char *objfilename)
 {
-    //printf("Obj::term()\n");
+    ElfObj::term(objfilename, NULL);
+}
+
+/*********************************
+ * Terminate package.
+ * Input:
+ *      fd      if not NULL, the object file is written to fd as it
+ *              is laid out, with the contents of the segments coming
+ *              straight from their buffers. Otherwise it is built
+ *              in the Outbuffer passed to Obj::init().
+ */
+
+void ElfObj::term(const char *objfilename, FILE *fd)
+{
+    //printf("ElfObj::term()\n");
 #if SCPP
     if (!errcnt)
 #endif
@@ -1080,7 +1060,7 @@ void Obj::term(const char *objfilename)
 
     if (configv.addlinenumbers)
     {
-        dwarf_termfile();
+        dwarf_termfile(objfilename);
     }
 
 #if MARS
@@ -1096,7 +1076,6 @@ void Obj::term(const char *objfilename)
     Elf32_Shdr *sechdr;
     seg_data *seg;
     void *symtab = elf_renumbersyms();
-    FILE *fd = NULL;
 
     int hdrsize = (I64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr));
 
@@ -1138,6 +1117,10 @@ void Obj::term(const char *objfilename)
         Elf32_Shdr *sechdr = MAP_SEG2SEC(i);        // corresponding section
         if (sechdr->sh_addralign < pseg->SDalignment)
             sechdr->sh_addralign = pseg->SDalignment;
+        const bool compressed = elf_iscompressed(sechdr, pseg);
+        const unsigned addralign = sechdr->sh_addralign;    // of the uncompressed data
+        if (compressed)
+            sechdr->sh_addralign = I64 ? 8 : 4;            // of the compression header
         foffset = elf_align(sechdr->sh_addralign,foffset);
         if (i == UDATA) // 0, BSS never allocated
         {   // but foffset as if it has
@@ -1162,7 +1145,14 @@ void Obj::term(const char *objfilename)
         {
             //printf(" - size %d\n",pseg->SDbuf->size());
             const size_t size = pseg->SDbuf->size();
-            fobjbuf->write(pseg->SDbuf->buf, size);
+            if (compressed)
+            {
+                sechdr->sh_flags |= SHF_COMPRESSED;
+                sechdr->sh_size = elf_writecompressed(pseg->SDbuf, addralign);
+                foffset += sechdr->sh_size;
+                continue;
+            }
+            objfile_write(fd, pseg->SDbuf->buf, size);
             const long nfoffset = elf_align(sechdr->sh_addralign, foffset + size);
             sechdr->sh_size = nfoffset - foffset;
             foffset = nfoffset;
@@ -1178,7 +1168,7 @@ void Obj::term(const char *objfilename)
         sechdr = &SecHdrTab[secidx_note];               // Notes
         sechdr->sh_size = note_data->size();
         sechdr->sh_offset = foffset;
-        fobjbuf->write(note_data->buf, sechdr->sh_size);
+        objfile_write(fd, note_data->buf, sechdr->sh_size);
         foffset += sechdr->sh_size;
     }
 
@@ -1187,7 +1177,7 @@ void Obj::term(const char *objfilename)
         sechdr = &SecHdrTab[SHN_COM];           // Comments
         sechdr->sh_size = comment_data->size();
         sechdr->sh_offset = foffset;
-        fobjbuf->write(comment_data->buf, sechdr->sh_size);
+        objfile_write(fd, comment_data->buf, sechdr->sh_size);
         foffset += sechdr->sh_size;
     }
 
@@ -1198,7 +1188,7 @@ void Obj::term(const char *objfilename)
     sechdr->sh_size = section_names->size();
     sechdr->sh_offset = foffset;
     //dbg_printf("section names offset %d\n",foffset);
-    fobjbuf->write(section_names->buf, sechdr->sh_size);
+    objfile_write(fd, section_names->buf, sechdr->sh_size);
     foffset += sechdr->sh_size;
 
     //
@@ -1212,7 +1202,7 @@ void Obj::term(const char *objfilename)
     sechdr->sh_info = local_cnt;
     foffset = elf_align(4,foffset);
     sechdr->sh_offset = foffset;
-    fobjbuf->write(symtab, sechdr->sh_size);
+    objfile_write(fd, symtab, sechdr->sh_size);
     foffset += sechdr->sh_size;
     util_free(symtab);
 
@@ -1222,7 +1212,7 @@ void Obj::term(const char *objfilename)
         sechdr = &SecHdrTab[secidx_shndx];
         sechdr->sh_size = shndx_data->size();
         sechdr->sh_offset = foffset;
-        fobjbuf->write(shndx_data->buf, sechdr->sh_size);
+        objfile_write(fd, shndx_data->buf, sechdr->sh_size);
         foffset += sechdr->sh_size;
     }
 
@@ -1230,7 +1220,7 @@ void Obj::term(const char *objfilename)
     sechdr = &SecHdrTab[SHN_STRINGS];   // Symbol Strings
     sechdr->sh_size = symtab_strings->size();
     sechdr->sh_offset = foffset;
-    fobjbuf->write(symtab_strings->buf, sechdr->sh_size);
+    objfile_write(fd, symtab_strings->buf, sechdr->sh_size);
     foffset += sechdr->sh_size;
 
     //
@@ -1267,7 +1257,7 @@ void Obj::term(const char *objfilename)
             }
             else
                 assert(seg->SDrelcnt == seg->SDrel->size() / sizeof(Elf32_Rel));
-            fobjbuf->write(seg->SDrel->buf, sechdr->sh_size);
+            objfile_write(fd, seg->SDrel->buf, sechdr->sh_size);
             foffset += sechdr->sh_size;
         }
     }
@@ -1311,6 +1301,11 @@ void Obj::term(const char *objfilename)
     // Now that we have correct offset to section header table, e_shoff,
     //  go back and re-output the elf header
     //
+    if (fd)
+    {
+        objfile_flush(fd);
+        fseek(fd, 0, SEEK_SET);
+    }
     fobjbuf->position(0, hdrsize);
     if (I64)
     {
@@ -1372,10 +1367,122 @@ void Obj::term(const char *objfilename)
         h.e_shnum     = e_shnum;
         fobjbuf->write(&h, hdrsize);
     }
+    if (fd)
+    {
+        objfile_flush(fd);
+        return;
+    }
     fobjbuf->position(foffset, 0);
     fobjbuf->flush();
 }
 
+/*****************************
+ * Write a split DWARF object file (.dwo), which only has the debug
+ * sections names[0 .. nsections] with contents bufs[0 .. nsections].
+ * They have no relocations, so there is no symbol table either.
+ */
+
+extern void error(const char *filename, unsigned linnum, unsigned charnum, const char *format, ...);
+
+void ElfObj::writedwo(const char *filename, int nsections,
+        const char **names, Outbuffer **bufs)
+{
+    //printf("ElfObj::writedwo(%s)\n", filename);
+    Outbuffer buf;
+    const int hdrsize = I64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+    buf.writezeros(hdrsize);
+
+    // Section header table is: null section, the debug sections, section names
+    Outbuffer shstrtab;
+    shstrtab.writeByte(0);
+    Elf32_Shdr *sechdrs = (Elf32_Shdr *)alloca((nsections + 2) * sizeof(Elf32_Shdr));
+    memset(sechdrs, 0, (nsections + 2) * sizeof(Elf32_Shdr));
+    for (int i = 0; i < nsections; i++)
+    {
+        Elf32_Shdr *sechdr = &sechdrs[i + 1];
+        sechdr->sh_name = shstrtab.size();
+        shstrtab.writeString(names[i]);
+        sechdr->sh_type = SHT_PROGBITS;
+        sechdr->sh_offset = buf.size();
+        sechdr->sh_size = bufs[i]->size();
+        sechdr->sh_addralign = 1;
+        buf.write(bufs[i]->buf, bufs[i]->size());
+    }
+    Elf32_Shdr *strhdr = &sechdrs[nsections + 1];
+    strhdr->sh_name = shstrtab.size();
+    shstrtab.writeString(".shstrtab");
+    strhdr->sh_type = SHT_STRTAB;
+    strhdr->sh_offset = buf.size();
+    strhdr->sh_size = shstrtab.size();
+    strhdr->sh_addralign = 1;
+    buf.write(shstrtab.buf, shstrtab.size());
+
+    while (buf.size() & 7)
+        buf.writeByte(0);
+    const unsigned e_shoff = buf.size();
+    const int e_shnum = nsections + 2;
+    if (I64)
+    {
+        for (int i = 0; i < e_shnum; i++)
+        {
+            Elf32_Shdr *p = &sechdrs[i];
+            Elf64_Shdr s;
+            memset(&s, 0, sizeof(s));
+            s.sh_name      = p->sh_name;
+            s.sh_type      = p->sh_type;
+            s.sh_offset    = p->sh_offset;
+            s.sh_size      = p->sh_size;
+            s.sh_addralign = p->sh_addralign;
+            buf.write(&s, sizeof(s));
+        }
+
+        Elf64_Ehdr *h = (Elf64_Ehdr *)buf.buf;
+        h->e_ident[EI_MAG0] = ELFMAG0;
+        h->e_ident[EI_MAG1] = ELFMAG1;
+        h->e_ident[EI_MAG2] = ELFMAG2;
+        h->e_ident[EI_MAG3] = ELFMAG3;
+        h->e_ident[EI_CLASS] = ELFCLASS64;
+        h->e_ident[EI_DATA] = ELFDATA2LSB;
+        h->e_ident[EI_VERSION] = EV_CURRENT;
+        h->e_ident[EI_OSABI] = ELFOSABI;
+        h->e_type      = ET_REL;
+        h->e_machine   = EM_X86_64;
+        h->e_version   = EV_CURRENT;
+        h->e_shoff     = e_shoff;
+        h->e_ehsize    = sizeof(Elf64_Ehdr);
+        h->e_phentsize = sizeof(Elf64_Phdr);
+        h->e_shentsize = sizeof(Elf64_Shdr);
+        h->e_shnum     = e_shnum;
+        h->e_shstrndx  = e_shnum - 1;
+    }
+    else
+    {
+        buf.write(sechdrs, e_shnum * sizeof(Elf32_Shdr));
+
+        Elf32_Ehdr *h = (Elf32_Ehdr *)buf.buf;
+        h->e_ident[EI_MAG0] = ELFMAG0;
+        h->e_ident[EI_MAG1] = ELFMAG1;
+        h->e_ident[EI_MAG2] = ELFMAG2;
+        h->e_ident[EI_MAG3] = ELFMAG3;
+        h->e_ident[EI_CLASS] = ELFCLASS32;
+        h->e_ident[EI_DATA] = ELFDATA2LSB;
+        h->e_ident[EI_VERSION] = EV_CURRENT;
+        h->e_ident[EI_OSABI] = ELFOSABI;
+        h->e_type      = ET_REL;
+        h->e_machine   = EM_386;
+        h->e_version   = EV_CURRENT;
+        h->e_shoff     = e_shoff;
+        h->e_ehsize    = sizeof(Elf32_Ehdr);
+        h->e_phentsize = sizeof(Elf32_Phdr);
+        h->e_shentsize = sizeof(Elf32_Shdr);
+        h->e_shnum     = e_shnum;
+        h->e_shstrndx  = e_shnum - 1;
+    }
+
+    if (file_write((char *)filename, buf.buf, buf.size()))
+        error(NULL, 0, 0, "cannot write file %s", filename);
+}
+
 /*****************************
  * Line number support.
  */
@@ -1807,7 +1914,7 @@ int ElfObj::getsegment(const char *name, const char *suffix, int type, int flags
         section_names->setsize(section_names->size() - 1);  // back up over terminating 0
         section_names->writeString(suffix);
     }
-    IDXSTR *pidx = (IDXSTR *)section_names_hashtable->get(&namidx);
+    IDXSTR *pidx = section_names_hashtable->get(namidx);
     if (*pidx)
     {   // this section name already exists
         section_names->setsize(namidx);                 // remove addition
@@ -1833,6 +1940,56 @@ int ElfObj::getsegment(const char *name, const char *suffix, int type, int flags
     return seg;
 }
 
+/********************************
+ * Get a new segment in a COMDAT section group of its own, so the linker
+ * keeps only one of the groups with the same signature.
+ * Unlike getsegment(), any number of segments can have the same name.
+ * Input:
+ *      name            name of segment
+ *      signature       name of the group
+ *      align           alignment
+ * Returns:
+ *      segment index of newly created segment
+ */
+
+int ElfObj::getgroupsegment(const char *name, const char *signature,
+        int type, int flags, int align)
+{
+    //printf("ElfObj::getgroupsegment(%s,%s)\n",name,signature);
+
+    // The group has to come before its members in the section header table
+    IDXSEC groupidx = elf_newsection2(Obj::addstr(section_names, ".group"),
+                SHT_GROUP,0,0,0,0,SHN_SYMTAB,0,4,sizeof(IDXSYM));
+    int groupseg = elf_getsegment2(groupidx,
+                elf_addsym(0, 0, 0, STT_SECTION, STB_LOCAL, groupidx), 0);
+    Outbuffer *groupbuf = SegData[groupseg]->SDbuf;
+    groupbuf->write32(GRP_COMDAT);
+
+    IDXSTR namidx = Obj::addstr(section_names, name);
+    IDXSEC shtidx = elf_newsection2(namidx,type,flags | SHF_GROUP,0,0,0,0,0,align,0);
+    groupbuf->write32(shtidx);
+
+    /* Create the relocation section now, as it has to be in the group too.
+     * ElfObj::addrel() fills it in.
+     */
+    IDXSTR relnamidx = section_names->size();
+    section_names->writeString(I64 ? ".rela" : ".rel");
+    section_names->setsize(section_names->size() - 1);
+    section_names->writeString(name);
+    IDXSEC relidx = elf_newsection2(relnamidx, I64 ? SHT_RELA : SHT_REL, SHF_GROUP,
+                0,0,0,SHN_SYMTAB,shtidx,I64 ? 8 : 4,I64 ? sizeof(Elf64_Rela) : sizeof(Elf32_Rel));
+    groupbuf->write32(relidx);
+
+    IDXSYM symidx = elf_addsym(0, 0, 0, STT_SECTION, STB_LOCAL, shtidx);
+    int seg = elf_getsegment2(shtidx, symidx, relidx);
+
+    // The group is named by a symbol
+    SecHdrTab[groupidx].sh_info = elf_addsym(Obj::addstr(symtab_strings, signature),
+                0, 0, STT_NOTYPE, STB_LOCAL, shtidx);
+    //printf("-ElfObj::getgroupsegment() = %d\n", seg);
+    return seg;
+}
+
 /**********************************
  * Reset code seg to existing seg.
  * Used after a COMDAT for a function is done.
@@ -2102,6 +2259,13 @@ int Obj::data_start(Symbol *sdata, targ_size_t datasize, int seg)
         sdata->Sseg = seg;      // wasn't any segment override
     else
         seg = sdata->Sseg;
+    if ((config.flags2 & CFG2datasec) && (seg == DATA || seg == UDATA))
+    {   // Give the variable a section of its own, so the linker can drop it
+        seg = (seg == DATA)
+            ? ElfObj::getsegment(".data.", cpp_mangle(sdata), SHT_PROGBITS, SHF_ALLOC|SHF_WRITE, I64 ? 16 : 4)
+            : ElfObj::getsegment(".bss.", cpp_mangle(sdata), SHT_NOBITS, SHF_ALLOC|SHF_WRITE, I64 ? 16 : 4);
+        sdata->Sseg = seg;
+    }
     targ_size_t offset = Offset(seg);
     if (sdata->Salignment > 0)
     {   if (SegData[seg]->SDalignment < sdata->Salignment)
@@ -2135,7 +2299,15 @@ void Obj::func_start(Symbol *sfunc)
 
     }
     else if (sfunc->Sseg == UNKNOWN)
-        sfunc->Sseg = CODE;
+    {
+        if (config.flags2 & CFG2funcsec)
+        {   // A section of its own, so the linker can drop or reorder it
+            sfunc->Sseg = ElfObj::getsegment(".text.", cpp_mangle(sfunc), SHT_PROGBITS, SHF_ALLOC|SHF_EXECINSTR, 16);
+            SegData[sfunc->Sseg]->SDsym = sfunc;
+        }
+        else
+            sfunc->Sseg = CODE;
+    }
     //dbg_printf("sfunc->Sseg %d CODE %d cseg %d Coffset %d\n",sfunc->Sseg,CODE,cseg,Coffset);
     cseg = sfunc->Sseg;
     assert(cseg == CODE || cseg > COMD);
@@ -2498,6 +2670,8 @@ void ElfObj::addrel(int seg, targ_size_t offset, unsigned type,
             relidx = SHN_RELTEXT;
         else if (secidx == SHN_DATA)
             relidx = SHN_RELDATA;
+        else if (segdata->SDrelidx)
+            relidx = segdata->SDrelidx;     // made by ElfObj::getgroupsegment()
         else
         {
             // Get the section name, and make a copy because
@@ -3102,11 +3276,29 @@ void objfile_term()
 }
 
 /**********************************
-  * Write to the object file
+  * Write to the object file.
+  * If writing to a file, what is in fobjbuf goes first, and the buffer
+  * is written directly without being copied into fobjbuf.
   */
 void objfile_write(FILE *fd, void *buffer, unsigned len)
 {
-    fobjbuf->write(buffer, len);
+    if (fd)
+    {
+        objfile_flush(fd);
+        fwrite(buffer, 1, len, fd);
+    }
+    else
+        fobjbuf->write(buffer, len);
+}
+
+/**********************************
+ * Write what has accumulated in fobjbuf to the object file,
+ * and empty fobjbuf.
+ */
+static void objfile_flush(FILE *fd)
+{
+    fwrite(fobjbuf->buf, 1, fobjbuf->size(), fd);
+    fobjbuf->setsize(0);
 }
 
 long elf_align(targ_size_t size,long foffset)
@@ -3119,6 +3311,54 @@ long elf_align(targ_size_t size,long foffset)
     return offset;
 }
 
+/*****************************
+ * Returns true if the section for pseg is a debug section to be
+ * written compressed.
+ */
+
+static bool elf_iscompressed(Elf32_Shdr *sechdr, seg_data *pseg)
+{
+    return (config.flags2 & CFG2gz) &&
+        pseg->SDbuf && pseg->SDbuf->size() > 64 &&        // not worth it for tiny ones
+        !(sechdr->sh_flags & SHF_ALLOC) &&
+        strncmp((const char *)section_names->buf + sechdr->sh_name, ".debug_", 7) == 0;
+}
+
+/*****************************
+ * Write section data as a compression header followed by the data
+ * compressed in zlib format.
+ * Relocations still refer to offsets in the uncompressed data.
+ * Params:
+ *      data = section data
+ *      addralign = alignment of the uncompressed data
+ * Returns:
+ *      number of bytes written
+ */
+
+static size_t elf_writecompressed(Outbuffer *data, unsigned addralign)
+{
+    const size_t start = fobjbuf->size();
+    if (I64)
+    {
+        Elf64_Chdr ch;
+        ch.ch_type = ELFCOMPRESS_ZLIB;
+        ch.ch_reserved = 0;
+        ch.ch_size = data->size();
+        ch.ch_addralign = addralign ? addralign : 1;
+        fobjbuf->write(&ch, sizeof(ch));
+    }
+    else
+    {
+        Elf32_Chdr ch;
+        ch.ch_type = ELFCOMPRESS_ZLIB;
+        ch.ch_size = data->size();
+        ch.ch_addralign = addralign ? addralign : 1;
+        fobjbuf->write(&ch, sizeof(ch));
+    }
+    zlib_compress(fobjbuf, data->buf, data->size());
+    return fobjbuf->size() - start;
+}
+
 /***************************************
  * Stuff pointer to ModuleInfo into its own section (minfo).
  */
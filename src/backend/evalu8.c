@@ -587,6 +587,23 @@ elem *selecte1(elem *e,type *t)
 
 #endif
 
+/******************************
+ * Multiply two 64 bit values, giving the upper half of the
+ * 128 bit product.
+ */
+
+static targ_ullong mulhi64(targ_ullong x, targ_ullong y)
+{
+    targ_ullong x0 = x & 0xFFFFFFFF;
+    targ_ullong x1 = x >> 32;
+    targ_ullong y0 = y & 0xFFFFFFFF;
+    targ_ullong y1 = y >> 32;
+    targ_ullong p01 = x0 * y1;
+    targ_ullong p10 = x1 * y0;
+    targ_ullong mid = ((x0 * y0) >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    return x1 * y1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
 /******************************
  * Evaluate a node with only constants as leaves.
  * Return with the result.
@@ -1043,7 +1060,15 @@ elem * evalu8(elem *e, goal_t goal)
         }
         break;
     case OPmul:
-        if (tyintegral(tym) || typtr(tym))
+        if (tysize(tym) == 16 && tyintegral(tym))
+        {
+            targ_ullong x = e1->EV.Vcent.lsw;
+            targ_ullong y = e2->EV.Vcent.lsw;
+            e->EV.Vcent.msw = mulhi64(x, y) + e1->EV.Vcent.msw * y +
+                              x * e2->EV.Vcent.msw;
+            e->EV.Vcent.lsw = x * y;
+        }
+        else if (tyintegral(tym) || typtr(tym))
             e->EV.Vllong = l1 * l2;
         else
         {   switch (tym)
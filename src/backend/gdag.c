@@ -13,6 +13,7 @@
 #if (SCPP || MARS) && !HTOD
 
 #include        <stdio.h>
+#include        <string.h>
 #include        <time.h>
 
 #include        "cc.h"
@@ -20,8 +21,10 @@
 #include        "el.h"
 #include        "go.h"
 #include        "ty.h"
+#include        "type.h"
 #include        "oper.h"
 #include        "vec.h"
+#include        "hashtab.h"
 
 static char __file__[] = __FILE__;      /* for tassert.h                */
 #include        "tassert.h"
@@ -921,4 +924,649 @@ STATIC void abeset(elem *e,vec_t ae,vec_t aeval,int flag)
     }
 }
 
+/************************* Global Value Numbering *************************/
+
+/* Expressions that compute the same value get the same value number (VN),
+ * found by hashing the operator with the value numbers of the operands.
+ * Each assignment to a variable gives it a new version, and an assignment
+ * (v = e) makes v's value number that of e, so equivalence is found
+ * through copies. Loads through pointers and reads of ambiguous
+ * variables include a memory generation, which changes at every store
+ * that could alias them.
+ *
+ * Walking the dominator tree, the first occurrence of each value is
+ * remembered. Later occurrences in blocks it dominates are replaced with
+ * a temporary, which the first occurrence is changed to assign.
+ */
+
+struct GvnKey
+{
+    unsigned op;
+    tym_t ty;
+    unsigned vn1, vn2;          // value numbers of the operands
+    targ_ullong c;              // constant, or offset of symbol
+    symbol *s;
+};
+
+struct GvnTraits
+{
+    static hash_t hash(const GvnKey& k)
+    {
+        hash_t h = k.op * 31 + k.ty;
+        h = h * 31 + k.vn1;
+        h = h * 31 + k.vn2;
+        h = h * 31 + (hash_t)(k.c ^ (k.c >> 32));
+        return h * 31 + (hash_t)k.s;
+    }
+
+    static bool equals(const GvnKey& k1, const GvnKey& k2)
+    {
+        return k1.op == k2.op && k1.ty == k2.ty &&
+            k1.vn1 == k2.vn1 && k1.vn2 == k2.vn2 &&
+            k1.c == k2.c && k1.s == k2.s;
+    }
+};
+
+struct GvnVal
+{
+    GvnKey key;                 // how the value is computed, op is 0 if unknown
+    elem *e;                    // first occurrence of the value
+    block *b;                   // block e is in
+    symbol *tmp;                // temporary e was changed to assign, if any
+};
+
+struct GvnVar
+{
+    unsigned ver;               // version
+    unsigned vn;                // value number of the version, 0 if unknown
+    tym_t ty;                   // type vn was assigned as
+};
+
+struct GvnUndo
+{
+    SYMIDX si;
+    GvnVar var;
+};
+
+#define GVN_MAXBLOCKS   1000    // don't bother with larger functions
+
+// Flags for gvnelem()
+#define GVlvalue        1       // elem is assigned to or has its address taken
+#define GVcond          2       // elem is conditionally executed
+#define GVnorep         4       // do not replace anything in the elem
+
+static HashTab<GvnKey, unsigned, GvnTraits> *gvntab;
+static GvnVal *gvnvals;         // indexed by value number
+static unsigned gvnvalnum_;     // next value number
+static unsigned gvnvalmax;      // dimension of gvnvals[]
+static GvnVar *gvnvars;         // indexed by Ssymnum, for the first gvnnsyms
+static SYMIDX gvnnsyms;
+static GvnUndo *gvnundo;        // stack to restore gvnvars[] with
+static unsigned gvnundotop;
+static unsigned gvnundomax;
+static unsigned gvngen;         // last version or memory generation used
+static unsigned gvnmem;         // current memory generation
+static unsigned *gvnchild;      // first child in the dominator tree
+static unsigned *gvnsib;        // next sibling in the dominator tree
+static vec_t *gvndefs;          // variables assigned in each block
+static bool *gvnmemdef;         // memory may be assigned in each block
+
+STATIC unsigned gvnvalnum(elem *e);
+
+/*************************
+ * Return a new value number.
+ */
+
+STATIC unsigned gvnnew()
+{
+    if (gvnvalnum_ == gvnvalmax)
+    {
+        unsigned n = gvnvalmax ? gvnvalmax * 2 : 256;
+        gvnvals = (GvnVal *) util_realloc(gvnvals, n, sizeof(GvnVal));
+        memset(gvnvals + gvnvalmax, 0, (n - gvnvalmax) * sizeof(GvnVal));
+        gvnvalmax = n;
+    }
+    return gvnvalnum_++;
+}
+
+STATIC unsigned gvnlookup(GvnKey *k)
+{
+    unsigned *pvn = gvntab->get(*k);
+    if (!*pvn)
+    {
+        unsigned vn = gvnnew();
+        gvnvals[vn].key = *k;
+        *pvn = vn;
+    }
+    return *pvn;
+}
+
+STATIC unsigned gvnconst(tym_t ty, targ_ullong c)
+{
+    GvnKey k;
+    memset(&k, 0, sizeof(k));
+    k.op = OPconst;
+    k.ty = tybasic(ty);
+    if (tysize(ty) < sizeof(targ_ullong))
+        c &= ((targ_ullong)1 << (tysize(ty) * 8)) - 1;
+    k.c = c;
+    return gvnlookup(&k);
+}
+
+/*************************
+ * Is s a variable that has versions?
+ */
+
+inline bool gvnversioned(symbol *s)
+{
+    return symbol_isintab(s) && s->Sflags & SFLunambig &&
+        s->Ssymnum >= 0 && s->Ssymnum < gvnnsyms;
+}
+
+/*************************
+ * Give variable si a new version with value number vn, undoably.
+ */
+
+STATIC void gvnsetvar(SYMIDX si, unsigned vn, tym_t ty)
+{
+    if (gvnundotop == gvnundomax)
+    {
+        gvnundomax = gvnundomax ? gvnundomax * 2 : 64;
+        gvnundo = (GvnUndo *) util_realloc(gvnundo, gvnundomax, sizeof(GvnUndo));
+    }
+    gvnundo[gvnundotop].si = si;
+    gvnundo[gvnundotop].var = gvnvars[si];
+    gvnundotop++;
+
+    gvnvars[si].ver = ++gvngen;
+    gvnvars[si].vn = vn;
+    gvnvars[si].ty = ty;
+}
+
+STATIC void gvnrestore(unsigned undotop)
+{
+    while (gvnundotop > undotop)
+    {
+        gvnundotop--;
+        gvnvars[gvnundo[gvnundotop].si] = gvnundo[gvnundotop].var;
+    }
+}
+
+/*************************
+ * Compute value number of e, which has no side effects.
+ */
+
+STATIC unsigned gvnvalnum(elem *e)
+{
+    unsigned op = e->Eoper;
+    tym_t ty = tybasic(e->Ety);
+
+    if (e->Ety & mTYvolatile || tyaggregate(ty))
+        return gvnnew();
+
+    GvnKey k;
+    memset(&k, 0, sizeof(k));
+    k.op = op;
+    k.ty = ty;
+    switch (op)
+    {
+        case OPconst:
+            if (!tyintegral(ty) && !typtr(ty))
+                return gvnnew();
+            return gvnconst(ty, el_tolong(e));
+
+        case OPvar:
+        {   symbol *s = e->EV.sp.Vsym;
+            k.s = s;
+            k.c = e->EV.sp.Voffset;
+            if (gvnversioned(s))
+            {
+                GvnVar *v = &gvnvars[s->Ssymnum];
+                if (v->vn && k.c == 0 && v->ty == ty)
+                    return v->vn;
+                k.vn1 = v->ver;
+            }
+            else
+                k.vn2 = gvnmem;
+            break;
+        }
+
+        case OPrelconst:
+            k.s = e->EV.sp.Vsym;
+            k.c = e->EV.sp.Voffset;
+            break;
+
+        case OPind:
+            k.vn1 = gvnvalnum(e->E1);
+            k.vn2 = gvnmem;
+            break;
+
+        case OPadd:
+        case OPmin:
+            if (e->E2->Eoper == OPconst && (tyintegral(ty) || typtr(ty)) &&
+                tyintegral(e->E2->Ety) && el_tolong(e->E2) != 0)
+            {
+                /* Reassociate (x + c1) + c2 to x + (c1 + c2),
+                 * and x - c to x + -c
+                 */
+                targ_ullong c = el_tolong(e->E2);
+                if (op == OPmin)
+                    c = -c;
+                tym_t tyc = e->E2->Ety;
+                unsigned vn = gvnvalnum(e->E1);
+                GvnKey *kx = &gvnvals[vn].key;
+                if (kx->op == OPadd && kx->ty == ty &&
+                    gvnvals[kx->vn2].key.op == OPconst)
+                {
+                    c += gvnvals[kx->vn2].key.c;
+                    tyc = gvnvals[kx->vn2].key.ty;
+                    vn = kx->vn1;
+                }
+                k.op = OPadd;
+                k.vn1 = vn;
+                k.vn2 = gvnconst(tyc, c);
+                break;
+            }
+            goto Lbinary;
+
+        case OPmul:
+        case OPdiv:
+        case OPmod:
+        case OPand:
+        case OPor:
+        case OPxor:
+        case OPshl:
+        case OPshr:
+        case OPashr:
+        case OProl:
+        case OPror:
+        case OPeqeq:
+        case OPne:
+        case OPlt:
+        case OPle:
+        case OPgt:
+        case OPge:
+        Lbinary:
+            k.vn1 = gvnvalnum(e->E1);
+            k.vn2 = gvnvalnum(e->E2);
+            if (OTcommut(op) && k.vn1 > k.vn2)
+            {   unsigned vn = k.vn1;
+                k.vn1 = k.vn2;
+                k.vn2 = vn;
+            }
+            break;
+
+        case OPneg:
+        case OPcom:
+        case OPnot:
+        case OPbool:
+            k.vn1 = gvnvalnum(e->E1);
+            break;
+
+        default:
+            if (!OTconv(op))
+                return gvnnew();
+            k.vn1 = gvnvalnum(e->E1);
+            break;
+    }
+    return gvnlookup(&k);
+}
+
+/*************************
+ * Is e worth replacing with a temporary if it is redundant?
+ */
+
+STATIC bool gvncandidate(elem *e)
+{
+    tym_t ty = e->Ety;
+    if (ty & mTYvolatile || (!tyintegral(ty) && !typtr(ty)))
+        return FALSE;
+    switch (e->Eoper)
+    {
+        case OPind:
+        case OPadd:
+        case OPmin:
+        case OPmul:
+        case OPdiv:
+        case OPmod:
+        case OPand:
+        case OPor:
+        case OPxor:
+        case OPshl:
+        case OPshr:
+        case OPashr:
+            return !el_sideeffect(e);
+    }
+    return FALSE;
+}
+
+/*************************
+ * Replace e with the temporary holding the value of v->e.
+ */
+
+STATIC void gvnreplace(elem *e, GvnVal *v)
+{
+    if (!v->tmp)
+    {
+        // Change the first occurrence h to (tmp = h)
+        elem *h = v->e;
+        elem *t = el_alloctmp(h->Ety);
+        elem *h2 = el_calloc();
+        el_copy(h2, h);
+        h->Eoper = OPeq;
+        h->E1 = t;
+        h->E2 = h2;
+        v->tmp = t->EV.sp.Vsym;
+    }
+    if (OTbinary(e->Eoper))
+        el_free(e->E2);
+    el_free(e->E1);
+    e->Eoper = OPvar;
+    e->EV.sp.Vsym = v->tmp;
+    e->EV.sp.Voffset = 0;
+    go.changes++;
+}
+
+/*************************
+ * Update versions for definition elem e.
+ * vn is the value number of the value assigned, 0 if unknown.
+ */
+
+STATIC void gvndef(elem *e, unsigned vn)
+{
+    if (Eunambig(e) && gvnversioned(e->E1->EV.sp.Vsym))
+    {
+        elem *ev = e->E1;
+        symbol *s = ev->EV.sp.Vsym;
+        if (ev->EV.sp.Voffset || tysize(ev->Ety) != type_size(s->Stype))
+            vn = 0;                     // only part of s is assigned
+        gvnsetvar(s->Ssymnum, vn, tybasic(ev->Ety));
+    }
+    else
+        gvnmem = ++gvngen;
+}
+
+/*************************
+ * Walk e in execution order, replacing redundant expressions.
+ */
+
+STATIC void gvnelem(elem *e, block *b, int flags)
+{
+    unsigned op = e->Eoper;
+
+    if (flags & GVlvalue)
+    {
+        switch (op)
+        {
+            case OPvar:
+                return;
+            case OPind:
+                gvnelem(e->E1, b, flags & ~GVlvalue);
+                return;
+            case OPbit:
+                gvnelem(e->E1, b, flags);
+                return;
+            case OPcomma:
+                gvnelem(e->E1, b, flags & ~GVlvalue);
+                gvnelem(e->E2, b, flags);
+                return;
+            default:
+                flags = (flags & ~GVlvalue) | GVnorep;
+                break;
+        }
+    }
+    else if (!(flags & GVnorep) && gvncandidate(e))
+    {
+        unsigned vn = gvnvalnum(e);
+        GvnVal *v = &gvnvals[vn];
+        if (v->e && dom(v->b, b))
+        {
+            gvnreplace(e, v);
+            return;
+        }
+        if (!(flags & GVcond))
+        {
+            v->e = e;
+            v->b = b;
+            v->tmp = NULL;
+        }
+    }
+
+    if (OTleaf(op))
+        return;
+
+    unsigned vn = 0;
+    switch (op)
+    {
+        case OPandand:
+        case OPoror:
+            gvnelem(e->E1, b, flags);
+            gvnelem(e->E2, b, flags | GVcond);
+            return;
+
+        case OPcond:
+            gvnelem(e->E1, b, flags);
+            gvnelem(e->E2->E1, b, flags | GVcond);
+            gvnelem(e->E2->E2, b, flags | GVcond);
+            return;
+
+        case OPaddr:
+            gvnelem(e->E1, b, flags | GVlvalue);
+            return;
+
+        case OPeq:
+            // Compute the value number before e->E2 gets rewritten
+            if (!(flags & (GVcond | GVnorep)) && e->E1->Eoper == OPvar &&
+                gvnversioned(e->E1->EV.sp.Vsym) && !el_sideeffect(e->E2))
+                vn = gvnvalnum(e->E2);
+            break;
+    }
+
+    int flags1 = OTassign(op) ? flags | GVlvalue : flags;
+    if (OTbinary(op))
+    {
+        if (ERTOL(e))
+        {   gvnelem(e->E2, b, flags);
+            gvnelem(e->E1, b, flags1);
+        }
+        else
+        {   gvnelem(e->E1, b, flags1);
+            gvnelem(e->E2, b, flags);
+        }
+    }
+    else
+        gvnelem(e->E1, b, flags1);
+
+    if (OTdef(op))
+        gvndef(e, (flags & (GVcond | GVnorep)) ? 0 : vn);
+}
+
+/*************************
+ * Accumulate in gvndefs[i] and gvnmemdef[i] what e assigns to.
+ * Returns:
+ *      FALSE if e contains inline assembler
+ */
+
+STATIC bool gvnaccumdefs(elem *e, unsigned i)
+{
+    while (1)
+    {
+        unsigned op = e->Eoper;
+        if (op == OPasm)
+            return FALSE;
+        if (OTdef(op))
+        {
+            if (Eunambig(e) && gvnversioned(e->E1->EV.sp.Vsym))
+                vec_setbit(e->E1->EV.sp.Vsym->Ssymnum, gvndefs[i]);
+            else
+                gvnmemdef[i] = TRUE;
+        }
+        if (OTbinary(op))
+        {
+            if (!gvnaccumdefs(e->E2, i))
+                return FALSE;
+        }
+        else if (!OTunary(op))
+            return TRUE;
+        e = e->E1;
+    }
+}
+
+/*************************
+ * On entry to dfo[i] from its immediate dominator dfo[id], give a new
+ * version to the variables, and memory, assigned on paths from dfo[id]
+ * to dfo[i] that do not go through dfo[id] again.
+ */
+
+STATIC void gvnregion(unsigned i, unsigned id, vec_t visited, block **stack, vec_t defs)
+{
+    unsigned sp = 0;
+    bool memdef = FALSE;
+
+    vec_clear(visited);
+    vec_clear(defs);
+    stack[sp++] = dfo[i];
+    while (sp)
+    {
+        block *b = stack[--sp];
+        for (list_t bl = b->Bpred; bl; bl = list_next(bl))
+        {
+            block *p = list_block(bl);
+            unsigned j = p->Bdfoidx;
+            if (j >= dfotop || dfo[j] != p || j == id || vec_testbit(j, visited))
+                continue;
+            vec_setbit(j, visited);
+            vec_orass(defs, gvndefs[j]);
+            memdef |= gvnmemdef[j];
+            stack[sp++] = p;
+        }
+    }
+
+    unsigned si;
+    foreach (si, gvnnsyms, defs)
+        gvnsetvar(si, 0, 0);
+    if (memdef)
+        gvnmem = ++gvngen;
+}
+
+STATIC void gvnblock(unsigned i, vec_t visited, block **stack, vec_t defs)
+{
+    block *b = dfo[i];
+    if (b->Belem)
+        gvnelem(b->Belem, b, 0);
+
+    for (unsigned c = gvnchild[i]; c; c = gvnsib[c])
+    {
+        unsigned undotop = gvnundotop;
+        unsigned mem = gvnmem;
+        gvnregion(c, i, visited, stack, defs);
+        gvnblock(c, visited, stack, defs);
+        gvnrestore(undotop);
+        gvnmem = mem;
+    }
+}
+
+/*************************************
+ * Global value numbering.
+ * Complements builddags(), which only finds lexically identical
+ * expressions: this also finds expressions equal by commutativity,
+ * by reassociating constants, or through copies to variables.
+ * Redundant loads are removed as well, while no store in between could
+ * change them.
+ */
+
+void gvnopt()
+{
+    unsigned i;
+
+    cmes("gvnopt()\n");
+    compdfo();
+    if (blockinit() || dfotop > GVN_MAXBLOCKS)
+        return;
+    for (i = 0; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        switch (b->BC)
+        {
+            case BCgoto:
+            case BCiftrue:
+            case BCret:
+            case BCretexp:
+            case BCexit:
+            case BCswitch:
+            case BCifthen:
+            case BCjmptab:
+                break;
+
+            default:
+                return;                 // exception handling
+        }
+        if (b->Btry)
+            return;
+    }
+    compdom();
+
+    gvnnsyms = globsym.top;
+    size_t nsyms = gvnnsyms ? gvnnsyms : 1;
+    gvndefs = (vec_t *) util_calloc(sizeof(vec_t), dfotop);
+    gvnmemdef = (bool *) util_calloc(sizeof(bool), dfotop);
+    bool ok = TRUE;
+    for (i = 0; i < dfotop; i++)
+    {
+        gvndefs[i] = vec_calloc(nsyms);
+        if (dfo[i]->Belem && !gvnaccumdefs(dfo[i]->Belem, i))
+            ok = FALSE;
+    }
+
+    if (ok)
+    {
+        // Build the dominator tree
+        unsigned *idom = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+        compidom(idom);
+        gvnchild = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+        gvnsib = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+        for (i = dfotop; --i > 0;)
+        {
+            gvnsib[i] = gvnchild[idom[i]];
+            gvnchild[idom[i]] = i;
+        }
+        util_free(idom);
+
+        gvntab = new HashTab<GvnKey, unsigned, GvnTraits>();
+        gvnvals = NULL;
+        gvnvalmax = 0;
+        gvnvalnum_ = 0;
+        gvnnew();                       // 0 is not a value number
+        gvnvars = (GvnVar *) util_calloc(sizeof(GvnVar), nsyms);
+        gvngen = 0;
+        for (SYMIDX si = 0; si < gvnnsyms; si++)
+            gvnvars[si].ver = ++gvngen;
+        gvnmem = ++gvngen;
+        gvnundotop = 0;
+
+        vec_t visited = vec_calloc(dfotop);
+        vec_t defs = vec_calloc(nsyms);
+        block **stack = (block **) util_calloc(sizeof(block *), dfotop);
+        gvnblock(0, visited, stack, defs);
+        util_free(stack);
+        vec_free(defs);
+        vec_free(visited);
+
+        util_free(gvnundo);
+        gvnundo = NULL;
+        gvnundomax = 0;
+        util_free(gvnvars);
+        util_free(gvnvals);
+        gvnvals = NULL;
+        delete gvntab;
+        util_free(gvnsib);
+        util_free(gvnchild);
+    }
+
+    for (i = 0; i < dfotop; i++)
+        vec_free(gvndefs[i]);
+    util_free(gvnmemdef);
+    util_free(gvndefs);
+}
+
 #endif
@@ -45,6 +45,7 @@ extern char debugy;            /* watch output to il buffer            */
 #define LF_STR "\n"
 
 struct seg_data;
+struct Outbuffer;
 
 /************************
  * Bit masks
@@ -484,6 +485,9 @@ void rtlsym_term();
 // compress.c
 char *id_compress(char *id, int idlen, size_t *plen);
 
+// deflate.c
+void zlib_compress(Outbuffer *buf, const unsigned char *data, size_t nbytes);
+
 // Dwarf
 void dwarf_CFA_set_loc(size_t location);
 void dwarf_CFA_set_reg_offset(int reg, int offset);
@@ -112,6 +112,8 @@ STATIC void countrefs(elem **pn , bool flag);
 STATIC int countrefs2(elem *e);
 STATIC void elimspec(loop *l);
 STATIC void elimspecwalk(elem **pn);
+STATIC bool loopunroll(loop *l);
+STATIC void loopdiv(loop *l);
 
 static  bool addblk;                    /* if TRUE, then we added a block */
 
@@ -329,6 +331,29 @@ bool dom(block *A,block *B)
   return vec_testbit(A->Bdfoidx,B->Bdom) != 0;
 }
 
+/****************************************
+ * Compute the immediate dominator of each block from Bdom.
+ * dfo[] is in reverse postorder, so of the blocks that dominate
+ * dfo[i], the immediate dominator is the last one before it.
+ * Output:
+ *      idom[i]         dfo index of the immediate dominator of dfo[i],
+ *                      idom[0] is 0
+ */
+
+void compidom(unsigned *idom)
+{
+  idom[0] = 0;
+  for (unsigned i = 1; i < dfotop; i++)
+  {     unsigned id = 0;
+        for (unsigned j = 1; j < i; j++)
+        {
+            if (vec_testbit(j,dfo[i]->Bdom))
+                id = j;
+        }
+        idom[i] = id;
+  }
+}
+
 /**********************
  * Find all the loops.
  */
@@ -788,6 +813,32 @@ restart:
         addblk = FALSE;
     }
 
+    /* Unroll loops before their induction variables are eliminated,
+     * while the trip counts can still be determined.
+     */
+    if ((go.mfoptim & (MFunroll | MFtime)) == (MFunroll | MFtime))
+    {
+        bool unrolled = FALSE;
+        for (l = startloop; l; l = l->Lnext)
+        {
+            if (loopunroll(l))
+                unrolled = TRUE;
+        }
+        if (unrolled)
+        {
+            compdfo();
+            blockinit();
+            compdom();
+            findloops(&startloop);
+        }
+    }
+
+    /* Remove redundant array bounds checks while the loop tests still
+     * compare the index, before induction variables are eliminated.
+     */
+    if (go.mfoptim & MFbounds)
+        opt_arraybounds();
+
     /* Do the loop optimizations. Note that accessing the loops */
     /* starting from startloop will access them in least nested */
     /* one first, thus moving LIs out as far as possible.       */
@@ -892,6 +943,9 @@ restart:
         //list_free(&l->Llis,FPNULL);
         cmes2("...Loop %p done...\n",l);
 
+        if ((go.mfoptim & (MFdiv | MFtime)) == (MFdiv | MFtime))
+            loopdiv(l);         // unsigned divisions by loop invariants
+
         if (go.mfoptim & MFliv)
         {       loopiv(l);              /* induction variables          */
                 if (addblk)             /* if we added a block          */
@@ -3450,4 +3504,1287 @@ STATIC void elimspecwalk(elem **pn)
   }
 }
 
+
+/************** LOOP UNROLLING **********************/
+
+#define UNROLL_SIZE     128     // max number of elems in an unrolled loop body
+#define UNROLL_FULL     16      // max number of iterations unrolled completely
+#define UNROLL_FACTOR   4       // number of body copies when unrolling partially
+#define UNROLL_MAXTRIP  0x10000 // max trip count searched for
+
+/*************************
+ * Count the elems in e.
+ * Returns:
+ *      number of elems, or UNROLL_SIZE + 1 if e cannot be duplicated or
+ *      reads the induction variable s in a way that cannot be adjusted
+ */
+
+STATIC unsigned unrollsize(elem *e, symbol *s)
+{
+    unsigned n = 0;
+    while (1)
+    {
+        elem_debug(e);
+        n++;
+        switch (e->Eoper)
+        {
+            case OPctor:
+            case OPdtor:
+            case OPddtor:
+            case OPmark:
+            case OPinfo:
+            case OPhalt:
+            case OPsetjmp:
+            case OPva_start:
+                return UNROLL_SIZE + 1;
+
+            case OPvar:
+                if (e->EV.sp.Vsym == s &&
+                    (e->EV.sp.Voffset || tysize(e->Ety) != tysize(s->ty())))
+                    return UNROLL_SIZE + 1;
+                return n;
+
+            case OPrelconst:
+                if (e->EV.sp.Vsym == s)
+                    return UNROLL_SIZE + 1;
+                return n;
+        }
+        if (OTbinary(e->Eoper))
+        {
+            n += unrollsize(e->E1, s);
+            if (n > UNROLL_SIZE)
+                return n;
+            e = e->E2;
+        }
+        else if (OTunary(e->Eoper))
+            e = e->E1;
+        else
+            return n;
+    }
+}
+
+/*************************
+ * Replace each read of induction variable s in *pe with (s + c).
+ */
+
+STATIC void unrollsubst(elem **pe, symbol *s, targ_llong c)
+{
+    elem *e = *pe;
+    if (OTbinary(e->Eoper))
+    {
+        unrollsubst(&e->E1, s, c);
+        unrollsubst(&e->E2, s, c);
+    }
+    else if (OTunary(e->Eoper))
+        unrollsubst(&e->E1, s, c);
+    else if (e->Eoper == OPvar && e->EV.sp.Vsym == s)
+        *pe = el_bin(OPadd, e->Ety, e, el_long(e->Ety, c));
+}
+
+/*************************
+ * Truncate v to the size of type ty, and sign or zero extend it.
+ */
+
+STATIC targ_llong unrollvalue(targ_llong v, tym_t ty)
+{
+    switch (tysize(ty))
+    {
+        case 1: return tyuns(ty) ? (targ_llong)(targ_uchar)v  : (targ_llong)(targ_schar)v;
+        case 2: return tyuns(ty) ? (targ_llong)(targ_ushort)v : (targ_llong)(targ_short)v;
+        case 4: return tyuns(ty) ? (targ_llong)(targ_ulong)v  : (targ_llong)(targ_long)v;
+        default: return v;
+    }
+}
+
+/*************************
+ * Evaluate (a op b) for values of type ty.
+ */
+
+STATIC bool unrollcmp(unsigned op, targ_llong a, targ_llong b, tym_t ty)
+{
+    if (tyuns(ty))
+    {
+        targ_ullong ua = a;
+        targ_ullong ub = b;
+        switch (op)
+        {
+            case OPlt:   return ua <  ub;
+            case OPle:   return ua <= ub;
+            case OPgt:   return ua >  ub;
+            case OPge:   return ua >= ub;
+            case OPeqeq: return ua == ub;
+            case OPne:   return ua != ub;
+        }
+    }
+    else
+    {
+        switch (op)
+        {
+            case OPlt:   return a <  b;
+            case OPle:   return a <= b;
+            case OPgt:   return a >  b;
+            case OPge:   return a >= b;
+            case OPeqeq: return a == b;
+            case OPne:   return a != b;
+        }
+    }
+    assert(0);
+    return FALSE;
+}
+
+/*************************
+ * Unroll loop l if it is a counted loop with a constant trip count
+ * and a small straight line body, of the form (after looprotate()):
+ *
+ *      s = c0;                         preheader
+ *      do
+ *      {   body;                       may not assign to s
+ *          s += c;                     basic IV increment
+ *      } while (s relop c1);
+ *
+ * The increment may also be in the condition, as ((s += c) relop c1),
+ * but not as (s++ relop c1), which compares the old value.
+ *
+ * If the trip count n is small, the body is repeated n times and the
+ * loop goes away. Otherwise the body is repeated UNROLL_FACTOR times
+ * in the loop, reading (s + i*c) in copy i and incrementing s once, so s
+ * remains a basic IV. The n % UNROLL_FACTOR remaining iterations are
+ * done in the preheader.
+ * Returns:
+ *      TRUE if l was unrolled, and the loop information needs recomputing
+ */
+
+STATIC bool loopunroll(loop *l)
+{
+    block *head = l->Lhead;
+    block *tail = l->Ltail;
+    block *pre = l->Lpreheader;
+    unsigned i;
+
+    if (!pre || pre->BC != BCgoto || pre->Btry != head->Btry ||
+        tail->BC != BCiftrue || !tail->Belem ||
+        tail->Bflags & BFLunrolled)
+        return FALSE;
+
+    // Loop is head (BCgoto) -> tail, or just one block
+    unsigned nblocks = 0;
+    foreach (i, dfotop, l->Lloop)
+        nblocks++;
+    if (head == tail)
+    {
+        if (nblocks != 1)
+            return FALSE;
+    }
+    else if (nblocks != 2 ||
+        head->BC != BCgoto || list_block(head->Bsucc) != tail ||
+        list_next(tail->Bpred) || head->Btry != tail->Btry)
+        return FALSE;
+
+    // tail goes back to head or leaves the loop
+    block *bexit;
+    bool backontrue;
+    if (list_block(tail->Bsucc) == head)
+    {   backontrue = TRUE;
+        bexit = list_block(list_next(tail->Bsucc));
+    }
+    else
+    {   backontrue = FALSE;
+        bexit = list_block(tail->Bsucc);
+        if (list_block(list_next(tail->Bsucc)) != head)
+            return FALSE;
+    }
+    if (bexit == head || bexit == tail)
+        return FALSE;
+
+    // The loop condition is last in tail
+    elem *cond;
+    for (cond = tail->Belem; cond->Eoper == OPcomma; cond = cond->E2)
+        ;
+    if (!OTrel(cond->Eoper) || cond->E2->Eoper != OPconst ||
+        !tyintegral(cond->E1->Ety))
+        return FALSE;
+
+    /* The loop is (body, s += c), s relop c1) or (body, (s += c) relop c1),
+     * and the body may start in head. Look at it as if head were merged
+     * into tail, but don't merge them until the loop is sure to be unrolled.
+     */
+    elem *ehead = (head != tail) ? head->Belem : NULL;
+    elem *etail;                // what precedes cond in tail
+    if (tail->Belem == cond)
+        etail = NULL;
+    else if (tail->Belem->Eoper == OPcomma && tail->Belem->E2 == cond)
+        etail = tail->Belem->E1;
+    else
+        return FALSE;
+    if (!ehead && !etail)
+        return FALSE;
+    elem *incr;
+    bool incrincond;
+    if (cond->E1->Eoper == OPvar)
+    {   // incr is the last statement, after at least one other
+        if (ehead && etail)
+            incr = etail;
+        else
+        {   elem *stmts = ehead ? ehead : etail;
+            if (stmts->Eoper != OPcomma)
+                return FALSE;   // no body, emptyloops() does these
+            incr = stmts->E2;
+        }
+        incrincond = FALSE;
+    }
+    else
+    {   incr = cond->E1;
+        incrincond = TRUE;
+    }
+    if (!(incr->Eoper == OPaddass || incr->Eoper == OPminass ||
+          incr->Eoper == OPpostinc || incr->Eoper == OPpostdec) ||
+        incr->E1->Eoper != OPvar || incr->E2->Eoper != OPconst)
+        return FALSE;
+    /* (s++ relop c1) compares the value before the increment, which
+     * neither the trip count below nor the split of the condition allow for
+     */
+    if (incrincond && (incr->Eoper == OPpostinc || incr->Eoper == OPpostdec))
+        return FALSE;
+    symbol *s = incr->E1->EV.sp.Vsym;
+    if (!symbol_isintab(s) || !(s->Sflags & SFLunambig) ||
+        !tyintegral(s->ty()) ||
+        incr->E1->EV.sp.Voffset || tysize(incr->E1->Ety) != tysize(s->ty()) ||
+        tysize(cond->E1->Ety) != tysize(s->ty()))
+        return FALSE;
+    if (!incrincond &&
+        (cond->E1->EV.sp.Vsym != s || cond->E1->EV.sp.Voffset))
+        return FALSE;
+
+    unsigned size = (incrincond ? 3 : 0) + (ehead && etail ? 1 : 0);
+    if (ehead)
+        size += unrollsize(ehead, s);
+    if (etail && size <= UNROLL_SIZE)
+        size += unrollsize(etail, s);
+    if (size > UNROLL_SIZE / 2)
+        return FALSE;
+
+    /* Check that s is a basic IV with incr being its only definition
+     * in the loop, and that only (s = c0) reaches the loop from outside.
+     */
+    flowrd();
+    if (go.deftop == 0)
+        return FALSE;
+    findbasivs(l);
+    bool isbasiciv = FALSE;
+    for (Iv *biv = l->Livlist; biv; biv = biv->IVnext)
+    {
+        if (biv->IVbasic == s && *biv->IVincr == incr)
+            isbasiciv = TRUE;
+    }
+    freeivlist(l->Livlist);
+    l->Livlist = NULL;
+    if (!isbasiciv)
+        return FALSE;
+
+    elem *einit = NULL;
+    list_t rdl = listrds(head->Binrd, incr->E1, NULL);
+    for (list_t bl = rdl; bl; bl = list_next(bl))
+    {
+        elem *d = list_elem(bl);
+        if (d == incr)
+            continue;
+        if (einit)
+        {   einit = NULL;
+            break;
+        }
+        einit = d;
+    }
+    list_free(&rdl, FPNULL);
+    if (!einit || einit->Eoper != OPeq ||
+        einit->E1->Eoper != OPvar || einit->E1->EV.sp.Vsym != s ||
+        einit->E1->EV.sp.Voffset || tysize(einit->E1->Ety) != tysize(s->ty()) ||
+        einit->E2->Eoper != OPconst)
+        return FALSE;
+
+    // Compute the trip count n, the body is executed at least once
+    tym_t ty = cond->E1->Ety;
+    unsigned op = backontrue ? cond->Eoper : rel_not(cond->Eoper);
+    switch (op)
+    {
+        case OPlt: case OPle: case OPgt: case OPge: case OPeqeq: case OPne:
+            break;
+        default:
+            return FALSE;
+    }
+    targ_llong step = el_tolong(incr->E2);
+    if (incr->Eoper == OPminass || incr->Eoper == OPpostdec)
+        step = -step;
+    targ_llong v = el_tolong(einit->E2);
+    targ_llong limit = unrollvalue(el_tolong(cond->E2), ty);
+    unsigned n;
+    for (n = 1; 1; n++)
+    {
+        if (n > UNROLL_MAXTRIP)
+            return FALSE;
+        v += step;
+        if (!unrollcmp(op, unrollvalue(v, ty), limit, ty))
+            break;
+    }
+
+    unsigned factor;
+    if (n <= UNROLL_FULL && n * size <= UNROLL_SIZE)
+        factor = n;
+    else
+    {   factor = UNROLL_FACTOR;
+        while (factor * size > UNROLL_SIZE)
+            factor--;
+        if (n < factor * 2)
+            return FALSE;
+    }
+
+    // Merge head into tail, so the loop is one block
+    if (ehead)
+    {   tail->Belem = el_combine(ehead, tail->Belem);
+        head->Belem = NULL;
+    }
+    elem *e = tail->Belem;
+    assert(e->Eoper == OPcomma && e->E2 == cond);
+
+    // Split ((s += c) relop c1) into (s += c, s relop c1)
+    if (incrincond)
+    {
+        cond->E1 = el_copytree(incr->E1);
+        e->E1 = el_combine(e->E1, incr);
+    }
+    // Now e is ((ebody, incr), cond)
+    elem *ebody = e->E1->E1;
+
+    if (factor == n)
+    {
+        // Repeat the body n times, and the loop goes away
+        elem *eu = NULL;
+        for (i = 1; i < n; i++)
+            eu = el_combine(eu, el_copytree(e->E1));
+        eu = el_combine(eu, e->E1);
+        e->E1 = NULL;
+        el_free(e);
+        tail->Belem = eu;
+        tail->BC = BCgoto;
+        list_subtract(&tail->Bsucc, head);
+        list_subtract(&head->Bpred, tail);
+        cmes3("Unrolled loop %p %d times\n", l, n);
+    }
+    else
+    {
+        // Do the remaining iterations in the preheader
+        for (i = 0; i < n % factor; i++)
+            pre->Belem = el_combine(pre->Belem, el_copytree(e->E1));
+
+        // Repeat the body factor times in the loop, copy i reading (s + i*step)
+        elem *eu = NULL;
+        for (i = 0; i < factor; i++)
+        {
+            elem *ec = (i + 1 < factor) ? el_copytree(ebody) : ebody;
+            if (i)
+                unrollsubst(&ec, s, i * step);
+            eu = el_combine(eu, ec);
+        }
+        e->E1->E1 = eu;
+
+        // and step factor times as far
+        elem *ec = incr->E2;
+        incr->E2 = el_long(ec->Ety, el_tolong(ec) * factor);
+        el_free(ec);
+        tail->Bflags |= BFLunrolled;
+        cmes3("Unrolled loop %p by %d\n", l, factor);
+    }
+    go.changes++;
+    return TRUE;
+}
+
+/************************* Array Bounds Checks ****************************/
+
+/* A fact about two simple operands (see boundsop()), one of:
+ *      RELlt   x < y, compared as unsigned, or x < c if y is NULL
+ *      RELeq   x == y, where x is an OPvar
+ */
+
+enum { RELlt, RELeq };
+
+struct Brel
+{
+    int op;             // RELxx
+    elem *x;
+    elem *y;
+    targ_ullong c;
+    bool ambig;         // refers to a variable that is not SFLunambig
+};
+
+#define BOUNDS_MAXREL   256     // max number of facts tracked
+
+static Brel *brel;              // the facts, with brelnum entries
+static unsigned brelnum;
+static bool brelcollect;        // TRUE while filling brel[]
+static unsigned bchecks;        // number of bounds checks seen while filling
+
+STATIC void boundselem(elem *e, vec_t v, bool remove);
+
+/*************************
+ * Return the variable operand e refers to, NULL if e is a constant.
+ */
+
+STATIC symbol *boundsvar(elem *e)
+{
+    while (e->Eoper != OPvar && e->Eoper != OPconst)
+        e = e->E1;
+    return e->Eoper == OPvar ? e->EV.sp.Vsym : NULL;
+}
+
+/*************************
+ * Is e a simple operand, which is an OPvar or OPconst,
+ * possibly under integral conversions?
+ */
+
+STATIC bool boundsop(elem *e)
+{
+    while (1)
+    {
+        if (e->Ety & mTYvolatile)
+            return FALSE;
+        switch (e->Eoper)
+        {
+            case OPconst:
+            case OPvar:
+                return TRUE;
+            case OP64_32:
+            case OP128_64:
+            case OPu32_64:
+            case OPs32_64:
+                e = e->E1;
+                break;
+            default:
+                return FALSE;
+        }
+    }
+}
+
+/*************************
+ * Fill in r with the fact that comparison e is truth.
+ * Returns:
+ *      FALSE if e cannot be expressed as x < y
+ */
+
+STATIC bool boundsfact(elem *e, bool truth, Brel *r)
+{
+    unsigned op = e->Eoper;
+    if (!OTrel2(op))
+        return FALSE;
+    if (!truth)
+        op = rel_not(op);
+
+    elem *x = e->E1;
+    elem *y = e->E2;
+    if (!tyintegral(x->Ety) || !tyuns(x->Ety) || !tyuns(y->Ety) ||
+        tysize(x->Ety) != tysize(y->Ety) ||
+        !boundsop(x) || !boundsop(y))
+        return FALSE;
+
+    targ_ullong max = ~(targ_ullong)0;
+    if (tysize(x->Ety) < sizeof(targ_ullong))
+        max >>= (sizeof(targ_ullong) - tysize(x->Ety)) * 8;
+
+    bool le = FALSE;
+    switch (op)
+    {
+        case OPlt:                      // x < y
+            break;
+        case OPgt:                      // y < x
+        {   elem *t = x; x = y; y = t;
+            break;
+        }
+        case OPle:                      // x < y + 1
+            le = TRUE;
+            break;
+        case OPge:                      // y < x + 1
+        {   elem *t = x; x = y; y = t;
+            le = TRUE;
+            break;
+        }
+        default:
+            return FALSE;
+    }
+
+    r->op = RELlt;
+    r->x = x;
+    r->y = y;
+    r->c = 0;
+    if (y->Eoper == OPconst)
+    {
+        r->y = NULL;
+        r->c = el_tolong(y) & max;
+        if (le)
+        {
+            if (r->c == max)
+                return FALSE;
+            r->c++;
+        }
+    }
+    else if (le)
+        return FALSE;
+    return TRUE;
+}
+
+/*************************
+ * Find fact r in brel[], adding it if brel[] is being filled.
+ * Returns:
+ *      index in brel[], -1 if not there
+ */
+
+STATIC int boundsindex(Brel *r)
+{
+    for (unsigned i = 0; i < brelnum; i++)
+    {
+        Brel *b = &brel[i];
+        if (b->op == r->op && b->c == r->c &&
+            el_match(b->x, r->x) &&
+            (b->y ? r->y && el_match(b->y, r->y) : !r->y))
+            return i;
+    }
+    if (!brelcollect || brelnum == BOUNDS_MAXREL)
+        return -1;
+
+    symbol *sx = boundsvar(r->x);
+    symbol *sy = r->y ? boundsvar(r->y) : NULL;
+    r->ambig = (sx && !(sx->Sflags & SFLunambig)) ||
+               (sy && !(sy->Sflags & SFLunambig));
+    brel[brelnum] = *r;
+    return brelnum++;
+}
+
+STATIC void boundsgen(vec_t v, Brel *r)
+{
+    int i = boundsindex(r);
+    if (v && i >= 0)
+        vec_setbit(i, v);
+}
+
+/*************************
+ * Remove from v the facts that refer to s.
+ * If s is NULL, remove those that refer to any ambiguous variable.
+ */
+
+STATIC void boundskill(vec_t v, symbol *s)
+{
+    if (!v)
+        return;
+    for (unsigned i = 0; i < brelnum; i++)
+    {
+        Brel *b = &brel[i];
+        if (s ? boundsvar(b->x) == s || (b->y && boundsvar(b->y) == s)
+              : b->ambig)
+            vec_clearbit(i, v);
+    }
+}
+
+/*************************
+ * Add to v the facts that hold when condition e is truth.
+ */
+
+STATIC void boundscond(elem *e, bool truth, vec_t v)
+{
+    while (1)
+    {
+        switch (e->Eoper)
+        {
+            case OPcomma:
+                e = e->E2;
+                continue;
+            case OPbool:
+                e = e->E1;
+                continue;
+            case OPnot:
+                e = e->E1;
+                truth = !truth;
+                continue;
+            case OPandand:
+            case OPoror:
+                if (truth != (e->Eoper == OPandand))
+                    return;
+                if (!el_sideeffect(e->E2))
+                    boundscond(e->E1, truth, v);
+                e = e->E2;
+                continue;
+            default:
+            {   Brel r;
+                if (boundsfact(e, truth, &r))
+                    boundsgen(v, &r);
+                return;
+            }
+        }
+    }
+}
+
+/*************************
+ * Are a and b known to be equal, by facts in v?
+ */
+
+STATIC bool boundsequal(vec_t v, elem *a, elem *b)
+{
+    if (el_match(a, b))
+        return TRUE;
+    unsigned i;
+    foreach (i, brelnum, v)
+    {
+        Brel *r = &brel[i];
+        if (r->op == RELeq &&
+            ((el_match(r->x, a) && el_match(r->y, b)) ||
+             (el_match(r->x, b) && el_match(r->y, a))))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*************************
+ * Is fact r implied by the facts in v?
+ */
+
+STATIC bool boundsknown(vec_t v, Brel *r)
+{
+    unsigned i;
+    foreach (i, brelnum, v)
+    {
+        Brel *f = &brel[i];
+        if (f->op != RELlt || !boundsequal(v, f->x, r->x))
+            continue;
+        if (r->y ? f->y && boundsequal(v, f->y, r->y)
+                 : !f->y && f->c <= r->c)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+STATIC vec_t boundsclone(vec_t v)
+{
+    return v ? vec_clone(v) : NULL;
+}
+
+/*************************
+ * Update v for the definition elem e.
+ */
+
+STATIC void boundsdef(elem *e, vec_t v)
+{
+    if (e->Eoper == OPasm)
+    {
+        if (v)
+            vec_clear(v);
+    }
+    else if (Eunambig(e))
+    {
+        elem *ev = e->E1;
+        symbol *s = ev->EV.sp.Vsym;
+        boundskill(v, s);
+
+        // Remember copies like (__limit = a.length) and (i = __key)
+        if (e->Eoper == OPeq && s->Sflags & SFLunambig &&
+            !(ev->Ety & mTYvolatile) && tyintegral(ev->Ety) &&
+            e->E2->Eoper != OPconst &&
+            tysize(ev->Ety) == tysize(e->E2->Ety) &&
+            boundsop(e->E2) && boundsvar(e->E2) != s)
+        {
+            Brel r;
+            r.op = RELeq;
+            r.x = ev;
+            r.y = e->E2;
+            r.c = 0;
+            boundsgen(v, &r);
+        }
+    }
+    else
+        boundskill(v, NULL);
+}
+
+/*************************
+ * Walk e in execution order, updating the facts in v.
+ * If remove, remove array bounds checks that are implied by the facts.
+ * v is NULL while brel[] is being filled.
+ */
+
+STATIC void boundselem(elem *e, vec_t v, bool remove)
+{
+    unsigned op = e->Eoper;
+
+    if (OTleaf(op))
+        return;
+
+    if (op == OPoror && e->Eflags & EFLAGS_arraybounds && OTcall(e->E2->Eoper))
+    {
+        /* (index < length || bounds error)
+         * The error does not return, so afterwards index < length.
+         */
+        boundselem(e->E1, v, remove);
+        Brel r;
+        if (!boundsfact(e->E1, TRUE, &r))
+            return;
+        if (brelcollect)
+            bchecks++;
+        if (remove && boundsknown(v, &r))
+        {
+#if MARS
+            if (config.flags2 & CFG2vbounds)
+                printf("%s(%u): vbounds: array bounds check removed\n",
+                    e->Esrcpos.Sfilename ? e->Esrcpos.Sfilename : "",
+                    e->Esrcpos.Slinnum);
+#endif
+            el_free(e->E2);
+            e->E2 = el_long(TYint, 1);
+            e->Eflags &= ~EFLAGS_arraybounds;
+            go.changes++;
+        }
+        boundsgen(v, &r);
+        return;
+    }
+
+    switch (op)
+    {
+        case OPandand:
+        case OPoror:
+        {   // E2 is only evaluated if E1 is (op == OPandand)
+            boundselem(e->E1, v, remove);
+            vec_t v2 = boundsclone(v);
+            boundscond(e->E1, op == OPandand, v2);
+            boundselem(e->E2, v2, remove);
+            if (v)
+            {   vec_andass(v, v2);
+                vec_free(v2);
+            }
+            return;
+        }
+
+        case OPcond:
+        {
+            boundselem(e->E1, v, remove);
+            vec_t v1 = boundsclone(v);
+            vec_t v2 = boundsclone(v);
+            boundscond(e->E1, TRUE, v1);
+            boundscond(e->E1, FALSE, v2);
+            boundselem(e->E2->E1, v1, remove);
+            boundselem(e->E2->E2, v2, remove);
+            if (v)
+            {   vec_and(v, v1, v2);
+                vec_free(v1);
+                vec_free(v2);
+            }
+            return;
+        }
+
+        default:
+            if (OTbinary(op))
+            {
+                if (ERTOL(e))
+                {   boundselem(e->E2, v, remove);
+                    boundselem(e->E1, v, remove);
+                }
+                else
+                {   boundselem(e->E1, v, remove);
+                    boundselem(e->E2, v, remove);
+                }
+            }
+            else
+                boundselem(e->E1, v, remove);
+            if (OTdef(op))
+                boundsdef(e, v);
+            break;
+    }
+}
+
+/*************************
+ * Compute in, the facts true on entry to b, from the facts out[]
+ * true on exit from each block, and etrue[] and efalse[] true on the
+ * edges out of BCiftrue blocks.
+ */
+
+STATIC void boundsin(block *b, vec_t in, vec_t *out, vec_t *etrue, vec_t *efalse, vec_t tmp)
+{
+    vec_clear(in);
+    if (b == startblock || !b->Bpred ||
+        b->BC == BCcatch || b->BC == BCjcatch)
+        return;
+
+    vec_set(in);
+    for (list_t bl = b->Bpred; bl; bl = list_next(bl))
+    {
+        block *p = list_block(bl);
+        unsigned i = p->Bdfoidx;
+
+        // Only ordinary control flow carries facts
+        if (i >= dfotop || dfo[i] != p ||
+            !(p->BC == BCgoto || p->BC == BCiftrue || p->BC == BCswitch ||
+              p->BC == BCifthen || p->BC == BCjmptab))
+        {
+            vec_clear(in);
+            return;
+        }
+        vec_copy(tmp, out[i]);
+        if (p->BC == BCiftrue)
+        {
+            block *bt = list_block(p->Bsucc);
+            block *bf = list_block(list_next(p->Bsucc));
+            if (bt != bf)
+                vec_orass(tmp, bt == b ? etrue[i] : efalse[i]);
+        }
+        vec_andass(in, tmp);
+    }
+}
+
+/*************************
+ * Remove array bounds checks (index < length || bounds error) generated
+ * by the front end, where index < length is known to hold already.
+ * The facts come from earlier bounds checks, and from the comparisons
+ * that control the branches leading to the check. This covers loops
+ * whose test compares the index with the length, which after looprotate()
+ * holds on entry to the loop body on both the preheader and loop edges.
+ *
+ * The facts are propagated forward with the must-dataflow equations:
+ *      in(b)  = intersection of (out(p) | edge facts(p,b)) for preds p
+ *      out(b) = transfer(in(b), b->Belem)
+ * Assignments remove facts about the assigned variable, indirect stores
+ * and calls remove facts about ambiguous variables.
+ *
+ * Checks are not hoisted out of loops, as that would change which
+ * iteration throws the RangeError.
+ */
+
+void opt_arraybounds()
+{
+    unsigned i;
+
+    cmes("opt_arraybounds()\n");
+    brel = (Brel *) util_calloc(sizeof(Brel), BOUNDS_MAXREL);
+    brelnum = 0;
+
+    // Collect the facts and see if there are any checks
+    bchecks = 0;
+    brelcollect = TRUE;
+    for (i = 0; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        if (b->Belem)
+        {
+            boundselem(b->Belem, NULL, FALSE);
+            if (b->BC == BCiftrue)
+            {
+                boundscond(b->Belem, TRUE, NULL);
+                boundscond(b->Belem, FALSE, NULL);
+            }
+        }
+    }
+    brelcollect = FALSE;
+    if (!bchecks)
+    {
+        util_free(brel);
+        brel = NULL;
+        return;
+    }
+
+    vec_t *out = (vec_t *) util_calloc(sizeof(vec_t), dfotop);
+    vec_t *etrue = (vec_t *) util_calloc(sizeof(vec_t), dfotop);
+    vec_t *efalse = (vec_t *) util_calloc(sizeof(vec_t), dfotop);
+    for (i = 0; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        out[i] = vec_calloc(brelnum);
+        vec_set(out[i]);
+        if (b->BC == BCiftrue)
+        {
+            etrue[i] = vec_calloc(brelnum);
+            efalse[i] = vec_calloc(brelnum);
+            if (b->Belem)
+            {   boundscond(b->Belem, TRUE, etrue[i]);
+                boundscond(b->Belem, FALSE, efalse[i]);
+            }
+        }
+    }
+
+    vec_t in = vec_calloc(brelnum);
+    vec_t tmp = vec_calloc(brelnum);
+    bool anychng;
+    do
+    {
+        anychng = FALSE;
+        for (i = 0; i < dfotop; i++)
+        {
+            block *b = dfo[i];
+            boundsin(b, in, out, etrue, efalse, tmp);
+            if (b->Belem)
+                boundselem(b->Belem, in, FALSE);
+            if (!vec_equal(in, out[i]))
+            {   vec_copy(out[i], in);
+                anychng = TRUE;
+            }
+        }
+    } while (anychng);
+
+    for (i = 0; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        if (b->Belem)
+        {
+            boundsin(b, in, out, etrue, efalse, tmp);
+            boundselem(b->Belem, in, TRUE);
+        }
+    }
+
+    vec_free(tmp);
+    vec_free(in);
+    for (i = 0; i < dfotop; i++)
+    {
+        vec_free(out[i]);
+        vec_free(etrue[i]);
+        vec_free(efalse[i]);
+    }
+    util_free(efalse);
+    util_free(etrue);
+    util_free(out);
+    util_free(brel);
+    brel = NULL;
+}
+
+
+/****************** Unsigned Division by Loop Invariants ******************/
+
+/* Unsigned x / d and x % d, where d is a variable that the loop never
+ * assigns, are replaced with a multiply and two shifts by constants computed
+ * once in the preheader (Granlund & Montgomery, "Division by Invariant
+ * Integers using Multiplication", figure 4.1). For N bit operands:
+ *      sh1 = min(l, 1), sh2 = max(l - 1, 0), where l = ceil(log2(d))
+ *      m   = 2**N * (2**l - d) / d + 1
+ *      t   = mulhi(m, x)
+ *      q   = (t + ((x - t) >> sh1)) >> sh2
+ * A zero d still reaches the original division, so it traps as before.
+ *
+ * For N == 64 there is no 128 by 64 bit division to compute m with, so
+ * it is only computed for 0 < d < 2**32, where two 64 bit divisions do.
+ * Other divisors get m = 0, which is never a valid multiplier, and take
+ * the original division. mulhi() is then the upper half of a 128 bit
+ * product, so this is only done for 64 bit targets.
+ */
+
+struct Ldiv
+{
+    symbol *v;          // the divisor
+    targ_size_t voffset;
+    tym_t ty;           // TYuint or TYullong
+    symbol *m;          // multiplier
+    symbol *sh1;        // shift counts
+    symbol *sh2;
+};
+
+#define DIV_MAX         8       // max number of divisors per loop
+
+static Ldiv divtab[DIV_MAX];
+static int divnum;
+
+/*************************
+ * Does e assign to v?
+ */
+
+STATIC bool divassigns(elem *e, symbol *v)
+{
+    while (1)
+    {
+        if (OTassign(e->Eoper) && e->E1->Eoper == OPvar && e->E1->EV.sp.Vsym == v)
+            return TRUE;
+        if (OTbinary(e->Eoper))
+        {
+            if (divassigns(e->E2, v))
+                return TRUE;
+            e = e->E1;
+        }
+        else if (OTunary(e->Eoper))
+            e = e->E1;
+        else
+            return FALSE;
+    }
+}
+
+/*************************
+ * Is e the guard left by divrewrite(), (d ? fast : x / d)?
+ * The divisions in it must not be rewritten again.
+ */
+
+STATIC bool divguarded(elem *e)
+{
+    if (e->Eoper != OPcond || e->E1->Eoper != OPvar || e->E2->Eoper != OPcolon)
+        return FALSE;
+    elem *ed = e->E2->E2;
+    return (ed->Eoper == OPdiv || ed->Eoper == OPmod) &&
+           ed->E2->Eoper == OPvar &&
+           ed->E2->EV.sp.Vsym == e->E1->EV.sp.Vsym &&
+           ed->E2->EV.sp.Voffset == e->E1->EV.sp.Voffset;
+}
+
+/*************************
+ * Compute the 32 bit multiplier and shift counts for divisor d
+ * in the preheader of l.
+ */
+
+STATIC void divinit32(Ldiv *ld, elem *d, loop *l)
+{
+    // sh1 = d > 1
+    elem *e = el_bin(OPgt, TYint, el_copytree(d), el_long(TYuint, 1));
+    appendelem(el_bin(OPeq, TYint, el_var(ld->sh1), e), &l->Lpreheader->Belem);
+
+    // sh2 = bsr((d - 1) | 1)
+    e = el_bin(OPmin, TYuint, el_copytree(d), el_long(TYuint, 1));
+    e = el_bin(OPor, TYuint, e, el_long(TYuint, 1));
+    e = el_una(OPbsr, TYint, e);
+    appendelem(el_bin(OPeq, TYint, el_var(ld->sh2), e), &l->Lpreheader->Belem);
+
+    // m = (((1 << (sh1 + sh2)) - d) << 32) / (d + (d == 0)) + 1
+    // The divisor is adjusted so a zero d does not trap here.
+    e = el_bin(OPadd, TYint, el_var(ld->sh1), el_var(ld->sh2));
+    e = el_bin(OPshl, TYullong, el_long(TYullong, 1), e);
+    e = el_bin(OPmin, TYullong, e, el_una(OPu32_64, TYullong, el_copytree(d)));
+    e = el_bin(OPshl, TYullong, e, el_long(TYint, 32));
+    elem *ed = el_bin(OPeqeq, TYuint, el_copytree(d), el_long(TYuint, 0));
+    ed = el_bin(OPadd, TYuint, el_copytree(d), ed);
+    e = el_bin(OPdiv, TYullong, e, el_una(OPu32_64, TYullong, ed));
+    e = el_bin(OPadd, TYuint, el_una(OP64_32, TYuint, e), el_long(TYuint, 1));
+    appendelem(el_bin(OPeq, TYuint, el_var(ld->m), e), &l->Lpreheader->Belem);
+}
+
+/*************************
+ * Compute the 64 bit multiplier and shift counts for divisor d
+ * in the preheader of l. m is 0 if d is 0 or does not fit in 32 bits.
+ */
+
+STATIC void divinit64(Ldiv *ld, elem *d, loop *l)
+{
+    elem **pe = &l->Lpreheader->Belem;
+    elem *e = el_alloctmp(TYullong);
+    symbol *dd = e->EV.sp.Vsym;
+    el_free(e);
+    e = el_alloctmp(TYullong);
+    symbol *qh = e->EV.sp.Vsym;
+    el_free(e);
+
+    // dd = (d - 1 < 0xFFFFFFFF) ? d : 1
+    // so none of the divisions below can trap or overflow
+    e = el_bin(OPmin, TYullong, el_copytree(d), el_long(TYullong, 1));
+    e = el_bin(OPlt, TYint, e, el_long(TYullong, 0xFFFFFFFF));
+    e = el_bin(OPcond, TYullong, e,
+            el_bin(OPcolon, TYullong, el_copytree(d), el_long(TYullong, 1)));
+    appendelem(el_bin(OPeq, TYullong, el_var(dd), e), pe);
+
+    // sh1 = dd > 1
+    e = el_bin(OPgt, TYint, el_var(dd), el_long(TYullong, 1));
+    appendelem(el_bin(OPeq, TYint, el_var(ld->sh1), e), pe);
+
+    // sh2 = bsr((dd - 1) | 1)
+    e = el_bin(OPmin, TYullong, el_var(dd), el_long(TYullong, 1));
+    e = el_bin(OPor, TYullong, e, el_long(TYullong, 1));
+    e = el_una(OPbsr, TYint, e);
+    appendelem(el_bin(OPeq, TYint, el_var(ld->sh2), e), pe);
+
+    // m = ((1 << (sh1 + sh2)) - dd) << 32
+    // which is less than dd << 32, so the quotient is computed
+    // 32 bits at a time
+    e = el_bin(OPadd, TYint, el_var(ld->sh1), el_var(ld->sh2));
+    e = el_bin(OPshl, TYullong, el_long(TYullong, 1), e);
+    e = el_bin(OPmin, TYullong, e, el_var(dd));
+    e = el_bin(OPshl, TYullong, e, el_long(TYint, 32));
+    appendelem(el_bin(OPeq, TYullong, el_var(ld->m), e), pe);
+
+    // qh = m / dd
+    e = el_bin(OPdiv, TYullong, el_var(ld->m), el_var(dd));
+    appendelem(el_bin(OPeq, TYullong, el_var(qh), e), pe);
+
+    // m = (dd == d) ? ((qh << 32) | ((m - qh * dd) << 32) / dd) + 1 : 0
+    e = el_bin(OPmul, TYullong, el_var(qh), el_var(dd));
+    e = el_bin(OPmin, TYullong, el_var(ld->m), e);
+    e = el_bin(OPshl, TYullong, e, el_long(TYint, 32));
+    e = el_bin(OPdiv, TYullong, e, el_var(dd));
+    e = el_bin(OPor, TYullong,
+            el_bin(OPshl, TYullong, el_var(qh), el_long(TYint, 32)), e);
+    e = el_bin(OPadd, TYullong, e, el_long(TYullong, 1));
+    e = el_bin(OPcond, TYullong,
+            el_bin(OPeqeq, TYint, el_var(dd), el_copytree(d)),
+            el_bin(OPcolon, TYullong, e, el_long(TYullong, 0)));
+    appendelem(el_bin(OPeq, TYullong, el_var(ld->m), e), pe);
+}
+
+/*************************
+ * Return the divtab[] entry for OPvar d, creating it and its
+ * preheader code if it is new. NULL if d is not suitable.
+ */
+
+STATIC Ldiv *divlookup(elem *d, loop *l)
+{
+    symbol *v = d->EV.sp.Vsym;
+
+    for (int j = 0; j < divnum; j++)
+    {
+        if (divtab[j].v == v && divtab[j].voffset == d->EV.sp.Voffset &&
+            tysize(divtab[j].ty) == tysize(d->Ety))
+            return &divtab[j];
+    }
+    if (divnum == DIV_MAX ||
+        !symbol_isintab(v) ||
+        !(v->Sflags & SFLunambig) ||
+        (v->ty() & mTYvolatile) ||
+        (d->Ety & mTYvolatile))
+        return NULL;
+
+    unsigned i;
+    foreach (i, dfotop, l->Lloop)
+    {
+        if (dfo[i]->Belem && divassigns(dfo[i]->Belem, v))
+            return NULL;
+    }
+
+    Ldiv *ld = &divtab[divnum++];
+    ld->v = v;
+    ld->voffset = d->EV.sp.Voffset;
+    ld->ty = tysize(d->Ety) == 8 ? TYullong : TYuint;
+    elem *e = el_alloctmp(ld->ty);
+    ld->m = e->EV.sp.Vsym;
+    el_free(e);
+    e = el_alloctmp(TYint);
+    ld->sh1 = e->EV.sp.Vsym;
+    el_free(e);
+    e = el_alloctmp(TYint);
+    ld->sh2 = e->EV.sp.Vsym;
+    el_free(e);
+
+    if (ld->ty == TYullong)
+        divinit64(ld, d, l);
+    else
+        divinit32(ld, d, l);
+
+    cmes2("loopdiv() hoisted multiplier for '%s'\n", v->Sident);
+    return ld;
+}
+
+/*************************
+ * Rewrite x / d or x % d in place as
+ *      (tx = x, d ? q : tx / d)
+ * or for 64 bits as
+ *      (tx = x, d ? (m ? q : tx / d) : tx / d)
+ * where q is computed from the divtab[] entry ld as described above.
+ * The outer test of d is kept for 64 bits so divguarded() finds it.
+ */
+
+STATIC void divrewrite(elem *e, Ldiv *ld)
+{
+    tym_t ty = ld->ty;
+    elem *d = e->E2;
+    elem *etx = el_alloctmp(ty);
+    symbol *tx = etx->EV.sp.Vsym;
+    elem *ett = el_alloctmp(ty);
+    symbol *tt = ett->EV.sp.Vsym;
+
+    // tt = mulhi(tx, m)
+    elem *ep;
+    if (ty == TYullong)
+    {
+        ep = el_bin(OPmul, TYucent, el_una(OPu64_128, TYucent, el_var(tx)),
+                                    el_una(OPu64_128, TYucent, el_var(ld->m)));
+        ep = el_una(OPmsw, TYullong, ep);
+    }
+    else
+    {
+        ep = el_bin(OPmul, TYullong, el_una(OPu32_64, TYullong, el_var(tx)),
+                                     el_una(OPu32_64, TYullong, el_var(ld->m)));
+        if (I64)
+            ep = el_una(OP64_32, TYuint, el_bin(OPshr, TYullong, ep, el_long(TYint, 32)));
+        else
+            ep = el_una(OPmsw, TYuint, ep);
+    }
+    ep = el_bin(OPeq, ty, ett, ep);
+
+    // q = (tt + ((tx - tt) >> sh1)) >> sh2
+    elem *eq = el_bin(OPmin, ty, el_var(tx), el_var(tt));
+    eq = el_bin(OPshr, ty, eq, el_var(ld->sh1));
+    eq = el_bin(OPadd, ty, el_var(tt), eq);
+    eq = el_bin(OPshr, ty, eq, el_var(ld->sh2));
+    eq = el_bin(OPcomma, ty, ep, eq);
+    if (e->Eoper == OPmod)
+    {   // tx - q * d
+        eq = el_bin(OPmul, ty, eq, el_copytree(d));
+        eq = el_bin(OPmin, ty, el_var(tx), eq);
+    }
+
+    if (ty == TYullong)
+    {   // m ? q : tx / d
+        elem *eslow = el_bin(e->Eoper, ty, el_var(tx), el_copytree(d));
+        eq = el_bin(OPcond, ty, el_var(ld->m), el_bin(OPcolon, ty, eq, eslow));
+    }
+
+    elem *eslow = el_bin(e->Eoper, ty, el_var(tx), el_copytree(d));
+    elem *ec = el_bin(OPcolon, ty, eq, eslow);
+    ec = el_bin(OPcond, ty, el_copytree(d), ec);
+
+    e->Eoper = OPcomma;
+    e->E1 = el_bin(OPeq, ty, etx, e->E1);
+    e->E2 = ec;
+    el_free(d);
+}
+
+/*************************
+ * Rewrite the divisions by loop invariants in tree e.
+ */
+
+STATIC void divelem(elem *e, loop *l)
+{
+    while (1)
+    {
+        if (divguarded(e))
+            return;
+        int sz = tysize(e->Ety);
+        if ((e->Eoper == OPdiv || e->Eoper == OPmod) &&
+            (sz == 4 || (sz == 8 && I64)) &&
+            tyuns(e->E1->Ety) && tysize(e->E1->Ety) == sz &&
+            tyuns(e->E2->Ety) && tysize(e->E2->Ety) == sz &&
+            !tyfloating(e->Ety) &&
+            e->E2->Eoper == OPvar)
+        {
+            Ldiv *ld = divlookup(e->E2, l);
+            if (ld)
+            {
+                divrewrite(e, ld);
+                go.changes++;
+                doflow = TRUE;
+            }
+        }
+        if (OTbinary(e->Eoper))
+        {
+            divelem(e->E2, l);
+            e = e->E1;
+        }
+        else if (OTunary(e->Eoper))
+            e = e->E1;
+        else
+            return;
+    }
+}
+
+/*************************
+ * Strength reduce the unsigned divisions by loop invariants in loop l.
+ * Signed divisions are left alone, and 64 bit ones are only done
+ * for 64 bit targets.
+ * Only done when optimizing for speed, as the preheader gets one or
+ * two 64 bit divisions and each quotient is computed with more code.
+ */
+
+STATIC void loopdiv(loop *l)
+{
+    if (I16)
+        return;
+    cmes2("loopdiv(%p)\n", l);
+    divnum = 0;
+    unsigned i;
+    foreach (i, dfotop, l->Lloop)
+    {
+        block *b = dfo[i];
+        if (b->Belem)
+            divelem(b->Belem, l);
+    }
+}
+
 #endif
@@ -69,16 +69,19 @@ int go_flag(char *cp)
 
     enum GL     // indices of various flags in flagtab[]
     {
-        GLO,GLall,GLcnp,GLcp,GLcse,GLda,GLdc,GLdv,GLli,GLliv,GLlocal,GLloop,
-        GLnone,GLo,GLreg,GLspace,GLspeed,GLtime,GLtree,GLvbe,GLMAX
+        GLO,GLall,GLbounds,GLcnp,GLcp,GLcse,GLda,GLdc,GLdiv,GLdv,GLgvn,GLli,
+        GLliv,GLlocal,GLloop,GLnone,GLo,GLreg,GLspace,GLspeed,GLssa,GLtime,GLtree,
+        GLunroll,GLvbe,GLMAX
     };
     static const char *flagtab[] =
-    {   "O","all","cnp","cp","cse","da","dc","dv","li","liv","local","loop",
-        "none","o","reg","space","speed","time","tree","vbe"
+    {   "O","all","bounds","cnp","cp","cse","da","dc","div","dv","gvn","li",
+        "liv","local","loop","none","o","reg","space","speed","ssa","time","tree",
+        "unroll","vbe"
     };
     static mftype flagmftab[] =
-    {   0,MFall,MFcnp,MFcp,MFcse,MFda,MFdc,MFdv,MFli,MFliv,MFlocal,MFloop,
-        0,0,MFreg,0,MFtime,MFtime,MFtree,MFvbe
+    {   0,MFall,MFbounds,MFcnp,MFcp,MFcse,MFda,MFdc,MFdiv,MFdv,MFgvn,MFli,
+        MFliv,MFlocal,MFloop,0,0,MFreg,0,MFtime,MFssa,MFtime,MFtree,
+        MFunroll,MFvbe
     };
 
     i = GLMAX;
@@ -88,18 +91,21 @@ int go_flag(char *cp)
     //printf("go_flag('%s')\n", cp);
     flag = binary(cp + 1,flagtab,GLMAX);
     if (go.mfoptim == 0 && flag != -1)
-        go.mfoptim = MFall & ~MFvbe;
+        go.mfoptim = MFall & ~(MFvbe | MFssa | MFgvn);
 
     if (*cp == '-')                     /* a regular -whatever flag     */
     {                                   /* cp -> flag string            */
         switch (flag)
         {
             case GLall:
+            case GLbounds:
             case GLcnp:
             case GLcp:
             case GLdc:
             case GLda:
+            case GLdiv:
             case GLdv:
+            case GLgvn:
             case GLcse:
             case GLli:
             case GLliv:
@@ -107,15 +113,17 @@ int go_flag(char *cp)
             case GLloop:
             case GLreg:
             case GLspeed:
+            case GLssa:
             case GLtime:
             case GLtree:
+            case GLunroll:
             case GLvbe:
                 go.mfoptim &= ~flagmftab[flag];    /* clear bits   */
                 break;
             case GLo:
             case GLO:
             case GLnone:
-                go.mfoptim |= MFall & ~MFvbe;      // inverse of -all
+                go.mfoptim |= MFall & ~(MFvbe | MFssa | MFgvn);  // inverse of -all
                 break;
             case GLspace:
                 go.mfoptim |= MFtime;      /* inverse of -time     */
@@ -131,11 +139,14 @@ int go_flag(char *cp)
         switch (flag)
         {
             case GLall:
+            case GLbounds:
             case GLcnp:
             case GLcp:
             case GLdc:
             case GLda:
+            case GLdiv:
             case GLdv:
+            case GLgvn:
             case GLcse:
             case GLli:
             case GLliv:
@@ -143,8 +154,10 @@ int go_flag(char *cp)
             case GLloop:
             case GLreg:
             case GLspeed:
+            case GLssa:
             case GLtime:
             case GLtree:
+            case GLunroll:
             case GLvbe:
                 go.mfoptim |= flagmftab[flag];     /* set bits     */
                 break;
@@ -291,10 +304,16 @@ void optfunc()
         if (go.changes && go.mfoptim & MFloop && (clock() - starttime) < 30 * CLOCKS_PER_SEC)
             continue;
 
+        // The SSA optimizer only handles some of the variables,
+        // constprop() and rmdeadass() still do the others
+        if (go.mfoptim & MFssa)
+            ssaopt();
         if (go.mfoptim & MFcnp)
             constprop();                /* constant propagation          */
         if (go.mfoptim & MFcp)
             copyprop();                 /* do copy propagation           */
+        if (go.mfoptim & MFgvn)
+            gvnopt();                   // global value numbering
 
         /* Floating point constants and string literals need to be
          * replaced with loads from variables in read-only data.
@@ -36,6 +36,11 @@ typedef unsigned mftype;        /* a type big enough for all the flags  */
 #define MFloop  0x800           // loop till no more changes
 #define MFtree  0x1000          // optelem (tree optimization)
 #define MFlocal 0x2000          // localize expressions
+#define MFunroll 0x4000         // loop unrolling
+#define MFbounds 0x8000         // array bounds check elimination
+#define MFgvn   0x10000         // global value numbering
+#define MFssa   0x20000         // SSA form constant propagation and dead assignments
+#define MFdiv   0x40000         // unsigned division by loop invariants
 #define MFall   (~0)            // do everything
 
 /**********************************
@@ -76,7 +81,7 @@ extern struct Go go;
 /* gdag.c */
 void builddags(void);
 void boolopt(void);
-void opt_arraybounds();
+void gvnopt(void);
 
 /* gflow.c */
 void flowrd(),flowlv(),flowae(),flowvbe(),
@@ -89,9 +94,14 @@ void localize(void);
 /* gloop.c */
 int blockinit(void);
 void compdom(void);
+void compidom(unsigned *idom);
 void loopopt(void);
+void opt_arraybounds(void);
 void updaterd(elem *n,vec_t GEN,vec_t KILL);
 
+/* gssa.c */
+bool ssaopt(void);
+
 /* gother.c */
 void rd_arraybounds(void);
 void rd_free();
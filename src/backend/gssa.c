@@ -0,0 +1,1233 @@
+// Compiler implementation of the D programming language
+// Copyright (c) 2016 by Digital Mars
+// All Rights Reserved
+// http://www.digitalmars.com
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// https://github.com/dlang/dmd/blob/master/src/backend/gssa.c
+
+
+#if (SCPP || MARS) && !HTOD
+
+#include        <stdio.h>
+#include        <string.h>
+#include        <time.h>
+
+#include        "cc.h"
+#include        "global.h"
+#include        "el.h"
+#include        "go.h"
+#include        "ty.h"
+#include        "type.h"
+#include        "oper.h"
+#include        "list.h"
+#include        "vec.h"
+#include        "hashtab.h"
+
+static char __file__[] = __FILE__;      /* for tassert.h                */
+#include        "tassert.h"
+
+/* Static single assignment form of the variables that are only referenced
+ * directly and as a whole. Each definition of such a variable, and each
+ * point where definitions merge, gets a value, and each use of the variable
+ * is mapped to the value that reaches it.
+ * The SSA form is kept in side tables; the elem trees are not renamed,
+ * so there is nothing to translate back out of SSA form. The results are
+ * applied by replacing uses with constants and by removing definitions
+ * whose value is never used.
+ */
+
+// Kinds of SsaVal
+enum
+{
+    SVentry,            // value on entry to the function
+    SVphi,              // merge at the start of a block
+    SVmerge,            // merge after a conditionally executed subtree
+    SVdef,              // assignment elem
+    SVcond,             // condition of a BCiftrue block, not a variable
+};
+
+// Lattice for sparse conditional constant propagation
+enum
+{
+    SLtop,              // not known yet
+    SLconst,            // constant
+    SLbottom,           // not constant
+};
+
+// SsaVal flags
+#define SSAinwork       1       // on the worklist
+#define SSAlive         2       // value is used
+#define SSAremovable    4       // dead SVdef can be removed with elimass()
+
+struct SsaVal
+{
+    unsigned char kind;
+    unsigned char lat;
+    unsigned char flags;
+    SYMIDX si;                  // variable, not for SVcond
+    unsigned b;                 // dfo index of the block the value is in
+    elem *e;                    // SVdef: assignment, SVcond: condition
+    unsigned prev;              // SVdef: value of the variable before e
+    unsigned ops;               // SVphi, SVmerge: operands in ssaops[]
+    unsigned nops;              // number of operands
+    unsigned next;              // SVphi: next phi of the block
+    unsigned users;             // values computed from this one, in ssalinks[]
+    unsigned uses;              // uses in the elem tree of this one, in ssauses[]
+    targ_llong c;               // value if SLconst
+};
+
+struct SsaUse
+{
+    elem *e;                    // OPvar
+    unsigned val;               // value reaching e, 0 once e is replaced
+    unsigned owner;             // SVdef or SVcond whose elem tree e is in
+    unsigned b;                 // dfo index of the block e is in
+    unsigned next;              // next use with the same owner
+};
+
+struct SsaLink
+{
+    unsigned val;
+    unsigned next;
+};
+
+struct SsaUndo
+{
+    SYMIDX si;
+    unsigned val;
+};
+
+struct SsaTraits
+{
+    static hash_t hash(elem * const& e)
+    {
+        return (hash_t)((size_t)e >> 4);
+    }
+
+    static bool equals(elem * const& e1, elem * const& e2)
+    {
+        return e1 == e2;
+    }
+};
+
+// Flags for ssaelem()
+#define SWvoid          1       // value of the elem is not used
+#define SWcond          2       // elem is conditionally executed
+#define SWlvalue        4       // elem is assigned to or has its address taken
+
+// Values of ssaout[]
+#define SOnone          -1      // no successor is executable yet
+#define SOall           2       // all successors are executable
+                                // else the index in Bsucc of the only one
+
+static SsaVal *ssavals;         // indexed by value, 0 is not a value
+static unsigned ssavaltop;
+static unsigned ssavalmax;
+static SsaUse *ssauses;         // 0 is not a use
+static unsigned ssausetop;
+static unsigned ssausemax;
+static SsaLink *ssalinks;       // 0 ends a list
+static unsigned ssalinktop;
+static unsigned ssalinkmax;
+static unsigned *ssaops;        // operands of SVphi and SVmerge
+static unsigned ssaoptop;
+static unsigned ssaopmax;
+static SsaUndo *ssaundo;        // stack to restore ssacur[] with
+static unsigned ssaundotop;
+static unsigned ssaundomax;
+static HashTab<elem *, unsigned, SsaTraits> *ssausetab; // OPvar to its use
+
+static SYMIDX ssansyms;
+static bool *ssacand;           // variable is in SSA form, indexed by Ssymnum
+static unsigned *ssacur;        // current value of each variable
+static unsigned *ssastamp;      // for ssamerge()
+static unsigned ssastampgen;
+static bool ssafail;            // function cannot be put in SSA form
+
+static unsigned *ssachild;      // first child in the dominator tree
+static unsigned *ssasib;        // next sibling in the dominator tree
+static unsigned *ssaphis;       // first phi of each block
+static unsigned *ssafirst;      // first value of the Belem of each block
+static unsigned *ssalast;       // last value of the Belem of each block + 1
+static unsigned *ssacond;       // SVcond of each block, 0 if none
+static bool *ssaexec;           // block is executable
+static int *ssaout;             // SOxxxx, successors that are executable
+static unsigned *ssawork;       // worklist of values
+static unsigned ssaworktop;
+static unsigned *ssablkwork;    // worklist of blocks
+static unsigned ssablkworktop;
+
+inline bool ssacandidate(symbol *s)
+{
+    return symbol_isintab(s) && s->Ssymnum >= 0 && s->Ssymnum < ssansyms &&
+        ssacand[s->Ssymnum];
+}
+
+inline bool ssaindfo(block *b)
+{
+    unsigned i = b->Bdfoidx;
+    return i < dfotop && dfo[i] == b;
+}
+
+/*************************
+ * Return a new value of kind for variable si in dfo[b].
+ */
+
+STATIC unsigned ssanewval(int kind, SYMIDX si, unsigned b)
+{
+    if (ssavaltop == ssavalmax)
+    {
+        ssavalmax = ssavalmax ? ssavalmax * 2 : 64;
+        ssavals = (SsaVal *) util_realloc(ssavals, ssavalmax, sizeof(SsaVal));
+    }
+    SsaVal *v = &ssavals[ssavaltop];
+    memset(v, 0, sizeof(SsaVal));
+    v->kind = kind;
+    v->lat = (kind == SVentry) ? SLbottom : SLtop;
+    v->si = si;
+    v->b = b;
+    return ssavaltop++;
+}
+
+/*************************
+ * Return index of n new operands in ssaops[], set to 0.
+ */
+
+STATIC unsigned ssanewops(unsigned n)
+{
+    if (ssaoptop + n > ssaopmax)
+    {
+        ssaopmax = (ssaopmax ? ssaopmax * 2 : 256) + n;
+        ssaops = (unsigned *) util_realloc(ssaops, ssaopmax, sizeof(unsigned));
+    }
+    memset(ssaops + ssaoptop, 0, n * sizeof(unsigned));
+    unsigned i = ssaoptop;
+    ssaoptop += n;
+    return i;
+}
+
+/*************************
+ * Record that value user is computed from value v.
+ */
+
+STATIC void ssauser(unsigned v, unsigned user)
+{
+    if (!v || !user)
+        return;
+    if (ssalinktop >= ssalinkmax)
+    {
+        ssalinkmax = ssalinkmax * 2 + 64;
+        ssalinks = (SsaLink *) util_realloc(ssalinks, ssalinkmax, sizeof(SsaLink));
+    }
+    ssalinks[ssalinktop].val = user;
+    ssalinks[ssalinktop].next = ssavals[v].users;
+    ssavals[v].users = ssalinktop++;
+}
+
+/*************************
+ * Record use e of the current value of its variable.
+ */
+
+STATIC void ssause(elem *e, unsigned b, unsigned owner)
+{
+    if (ssausetop >= ssausemax)
+    {
+        ssausemax = ssausemax * 2 + 64;
+        ssauses = (SsaUse *) util_realloc(ssauses, ssausemax, sizeof(SsaUse));
+    }
+    unsigned u = ssausetop++;
+    SsaUse *pu = &ssauses[u];
+    pu->e = e;
+    pu->val = ssacur[e->EV.sp.Vsym->Ssymnum];
+    pu->owner = owner;
+    pu->b = b;
+    pu->next = 0;
+    if (owner)
+    {
+        pu->next = ssavals[owner].uses;
+        ssavals[owner].uses = u;
+    }
+    *ssausetab->get(e) = u;
+    ssauser(pu->val, owner);
+}
+
+/*************************
+ * Make v the current value of variable si, undoably.
+ */
+
+STATIC void ssasetcur(SYMIDX si, unsigned v)
+{
+    if (ssaundotop == ssaundomax)
+    {
+        ssaundomax = ssaundomax ? ssaundomax * 2 : 64;
+        ssaundo = (SsaUndo *) util_realloc(ssaundo, ssaundomax, sizeof(SsaUndo));
+    }
+    ssaundo[ssaundotop].si = si;
+    ssaundo[ssaundotop].val = ssacur[si];
+    ssaundotop++;
+    ssacur[si] = v;
+}
+
+STATIC void ssarestore(unsigned undotop)
+{
+    while (ssaundotop > undotop)
+    {
+        ssaundotop--;
+        ssacur[ssaundo[ssaundotop].si] = ssaundo[ssaundotop].val;
+    }
+}
+
+/*************************
+ * Drop the variables from SSA form that e references other than
+ * directly and as a whole.
+ */
+
+STATIC void ssascan(elem *e, int flags)
+{
+    unsigned op = e->Eoper;
+
+    if (op == OPvar || op == OPrelconst)
+    {
+        symbol *s = e->EV.sp.Vsym;
+        if (ssacandidate(s) &&
+            (flags & SWlvalue || op == OPrelconst ||
+             e->EV.sp.Voffset || e->Ety & mTYvolatile ||
+             !tyintegral(e->Ety) || tysize(e->Ety) != type_size(s->Stype)))
+            ssacand[s->Ssymnum] = FALSE;
+        return;
+    }
+    if (op == OPasm)
+        ssafail = TRUE;
+    if (OTleaf(op))
+        return;
+
+    if (flags & SWlvalue)
+    {
+        switch (op)
+        {
+            case OPind:
+                ssascan(e->E1, 0);
+                return;
+            case OPbit:
+                ssascan(e->E1, flags);
+                return;
+            case OPcomma:
+                ssascan(e->E1, 0);
+                ssascan(e->E2, flags);
+                return;
+        }
+    }
+    if (OTbinary(op))
+        ssascan(e->E2, 0);
+    if (OTassign(op) && e->E1->Eoper == OPvar)
+        ssascan(e->E1, 0);              // definition of the whole variable
+    else
+        ssascan(e->E1, (OTassign(op) || op == OPaddr) ? SWlvalue : 0);
+}
+
+/*************************
+ * Set in defs the variables that e assigns to.
+ */
+
+STATIC void ssaaccumdefs(elem *e, vec_t defs)
+{
+    while (1)
+    {
+        unsigned op = e->Eoper;
+        if (OTassign(op) && e->E1->Eoper == OPvar && ssacandidate(e->E1->EV.sp.Vsym))
+            vec_setbit(e->E1->EV.sp.Vsym->Ssymnum, defs);
+        if (OTbinary(op))
+            ssaaccumdefs(e->E2, defs);
+        else if (!OTunary(op))
+            return;
+        e = e->E1;
+    }
+}
+
+/*************************
+ * Can assignment e be removed with elimass() if the value it
+ * assigns is not used?
+ */
+
+STATIC bool ssaremovable(elem *e)
+{
+    switch (e->Eoper)
+    {
+        case OPeq:
+        case OPaddass:
+        case OPminass:
+        case OPmulass:
+        case OPdivass:
+        case OPmodass:
+        case OPandass:
+        case OPorass:
+        case OPxorass:
+        case OPshlass:
+        case OPshrass:
+        case OPashrass:
+        case OPpostinc:
+        case OPpostdec:
+            return !el_sideeffect(e->E2);
+
+        case OPnegass:
+            return TRUE;
+    }
+    return FALSE;
+}
+
+STATIC void ssaelem(elem *e, unsigned b, unsigned owner, int flags);
+
+/*************************
+ * After conditionally executed elems, merge the values of the variables
+ * they assigned with the values they had before.
+ * Input:
+ *      mark    ssaundotop before the elems
+ */
+
+STATIC void ssamerge(unsigned mark, unsigned b)
+{
+    unsigned top = ssaundotop;
+    ++ssastampgen;
+    for (unsigned j = mark; j < top; j++)
+    {
+        SYMIDX si = ssaundo[j].si;
+        if (ssastamp[si] == ssastampgen)
+            continue;
+        ssastamp[si] = ssastampgen;
+
+        unsigned before = ssaundo[j].val;       // first entry for si
+        unsigned after = ssacur[si];
+        unsigned m = ssanewval(SVmerge, si, b);
+        ssavals[m].nops = 2;
+        ssavals[m].ops = ssanewops(2);
+        ssaops[ssavals[m].ops] = before;
+        ssaops[ssavals[m].ops + 1] = after;
+        ssauser(before, m);
+        ssauser(after, m);
+        ssasetcur(si, m);
+    }
+}
+
+STATIC void ssacondelem(elem *e, unsigned b, unsigned owner)
+{
+    unsigned mark = ssaundotop;
+    ssaelem(e, b, owner, SWcond);
+    ssamerge(mark, b);
+}
+
+/*************************
+ * Walk e in execution order, creating values for the definitions
+ * and recording the uses.
+ */
+
+STATIC void ssaelem(elem *e, unsigned b, unsigned owner, int flags)
+{
+    unsigned op = e->Eoper;
+
+    if (op == OPvar)
+    {
+        if (!(flags & SWlvalue) && ssacandidate(e->EV.sp.Vsym))
+            ssause(e, b, owner);
+        return;
+    }
+    if (OTleaf(op))
+        return;
+
+    int cflags = flags & SWcond;        // flags for operands whose value is used
+    if (flags & SWlvalue)
+    {
+        switch (op)
+        {
+            case OPind:
+                ssaelem(e->E1, b, owner, cflags);
+                return;
+            case OPbit:
+                ssaelem(e->E1, b, owner, flags);
+                return;
+            case OPcomma:
+                ssaelem(e->E1, b, owner, cflags | SWvoid);
+                ssaelem(e->E2, b, owner, flags);
+                return;
+        }
+        flags = cflags;
+    }
+
+    switch (op)
+    {
+        case OPcomma:
+            ssaelem(e->E1, b, owner, cflags | SWvoid);
+            ssaelem(e->E2, b, owner, flags);
+            return;
+
+        case OPandand:
+        case OPoror:
+            ssaelem(e->E1, b, owner, cflags);
+            ssacondelem(e->E2, b, owner);
+            return;
+
+        case OPcond:
+            ssaelem(e->E1, b, owner, cflags);
+            ssacondelem(e->E2->E1, b, owner);
+            ssacondelem(e->E2->E2, b, owner);
+            return;
+
+        case OPaddr:
+            ssaelem(e->E1, b, owner, cflags | SWlvalue);
+            return;
+    }
+
+    if (OTassign(op) && e->E1->Eoper == OPvar && ssacandidate(e->E1->EV.sp.Vsym))
+    {
+        SYMIDX si = e->E1->EV.sp.Vsym->Ssymnum;
+        unsigned prev = ssacur[si];
+        unsigned v = ssanewval(SVdef, si, b);
+        ssavals[v].e = e;
+        ssavals[v].prev = prev;
+        if (op != OPeq)
+            ssauser(prev, v);
+        if (OTbinary(op))
+            ssaelem(e->E2, b, v, cflags);
+        if (op != OPeq && ssacur[si] != prev)
+            ssafail = TRUE;             // (v op= (v = e)), don't bother
+        if ((flags & (SWvoid | SWcond)) == SWvoid && ssaremovable(e))
+            ssavals[v].flags |= SSAremovable;
+        ssasetcur(si, v);
+        return;
+    }
+
+    int flags1 = OTassign(op) ? cflags | SWlvalue : cflags;
+    if (OTbinary(op))
+    {
+        if (ERTOL(e))
+        {   ssaelem(e->E2, b, owner, cflags);
+            ssaelem(e->E1, b, owner, flags1);
+        }
+        else
+        {   ssaelem(e->E1, b, owner, flags1);
+            ssaelem(e->E2, b, owner, cflags);
+        }
+    }
+    else
+        ssaelem(e->E1, b, owner, flags1);
+}
+
+/*************************
+ * Rename the variables in dfo[i] and the blocks it dominates.
+ */
+
+STATIC void ssarename(unsigned i)
+{
+    block *b = dfo[i];
+    unsigned undotop = ssaundotop;
+
+    for (unsigned p = ssaphis[i]; p; p = ssavals[p].next)
+        ssasetcur(ssavals[p].si, p);
+
+    ssafirst[i] = ssavaltop;
+    elem *e = b->Belem;
+    if (e)
+    {
+        if (b->BC == BCiftrue)
+        {
+            // The condition is the last expression evaluated
+            while (e->Eoper == OPcomma)
+            {
+                ssaelem(e->E1, i, 0, SWvoid);
+                e = e->E2;
+            }
+            unsigned v = ssanewval(SVcond, 0, i);
+            ssavals[v].e = e;
+            ssacond[i] = v;
+            ssaelem(e, i, v, 0);
+        }
+        else
+        {
+            int flags = 0;
+            if (b->BC == BCgoto || b->BC == BCret || b->BC == BCexit)
+                flags = SWvoid;
+            ssaelem(e, i, 0, flags);
+        }
+    }
+    ssalast[i] = ssavaltop;
+
+    // Fill in the operands of the phis of the successors
+    for (list_t bl = b->Bsucc; bl; bl = list_next(bl))
+    {
+        block *s = list_block(bl);
+        if (!ssaindfo(s))
+            continue;
+        unsigned k = 0;
+        for (list_t pl = s->Bpred; pl; pl = list_next(pl), k++)
+        {
+            if (list_block(pl) != b)
+                continue;
+            for (unsigned p = ssaphis[s->Bdfoidx]; p; p = ssavals[p].next)
+            {
+                unsigned v = ssacur[ssavals[p].si];
+                ssaops[ssavals[p].ops + k] = v;
+                ssauser(v, p);
+            }
+        }
+    }
+
+    for (unsigned c = ssachild[i]; c; c = ssasib[c])
+        ssarename(c);
+    ssarestore(undotop);
+}
+
+/*************************
+ * Place a phi for each variable at the iterated dominance frontier
+ * of the blocks that assign to it.
+ */
+
+STATIC void ssaplacephis(unsigned *idom, vec_t *defs)
+{
+    unsigned i;
+
+    // Dominance frontiers, see Cooper, Harvey & Kennedy,
+    // "A Simple, Fast Dominance Algorithm"
+    list_t *df = (list_t *) util_calloc(sizeof(list_t), dfotop);
+    for (i = 1; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        if (!b->Bpred || !list_next(b->Bpred))
+            continue;
+        for (list_t bl = b->Bpred; bl; bl = list_next(bl))
+        {
+            block *p = list_block(bl);
+            if (!ssaindfo(p))
+                continue;
+            for (unsigned r = p->Bdfoidx; r != idom[i]; r = idom[r])
+            {
+                if (df[r] && list_block(df[r]) == b)
+                    break;              // already there, and above r too
+                list_prepend(&df[r], b);
+            }
+        }
+    }
+
+    unsigned *work = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    unsigned *inwork = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    unsigned *hasphi = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    for (SYMIDX si = 0; si < ssansyms; si++)
+    {
+        if (!ssacand[si])
+            continue;
+        unsigned stamp = si + 1;
+        unsigned top = 0;
+        for (i = 0; i < dfotop; i++)
+        {
+            if (vec_testbit(si, defs[i]))
+            {   inwork[i] = stamp;
+                work[top++] = i;
+            }
+        }
+        while (top)
+        {
+            i = work[--top];
+            for (list_t l = df[i]; l; l = list_next(l))
+            {
+                block *b = list_block(l);
+                unsigned j = b->Bdfoidx;
+                if (hasphi[j] == stamp)
+                    continue;
+                hasphi[j] = stamp;
+
+                unsigned p = ssanewval(SVphi, si, j);
+                unsigned n = list_nitems(b->Bpred);
+                ssavals[p].nops = n;
+                ssavals[p].ops = ssanewops(n);
+                ssavals[p].next = ssaphis[j];
+                ssaphis[j] = p;
+
+                if (inwork[j] != stamp)
+                {   inwork[j] = stamp;
+                    work[top++] = j;
+                }
+            }
+        }
+    }
+    util_free(hasphi);
+    util_free(inwork);
+    util_free(work);
+
+    for (i = 0; i < dfotop; i++)
+        list_free(&df[i], FPNULL);
+    util_free(df);
+}
+
+/******************************** SCCP *********************************/
+
+STATIC int ssameet(int lat1, targ_llong *pc1, int lat2, targ_llong c2)
+{
+    if (lat2 == SLtop)
+        return lat1;
+    if (lat1 == SLtop)
+    {   *pc1 = c2;
+        return lat2;
+    }
+    if (lat1 == SLbottom || lat2 == SLbottom || *pc1 != c2)
+        return SLbottom;
+    return SLconst;
+}
+
+/*************************
+ * Fold op applied to constants.
+ */
+
+STATIC int ssafold(unsigned op, tym_t ty, tym_t ty1, targ_llong c1, tym_t ty2, targ_llong c2, targ_llong *pc)
+{
+    elem *e = OTbinary(op)
+        ? el_bin(op, ty, el_long(ty1, c1), el_long(ty2, c2))
+        : el_una(op, ty, el_long(ty1, c1));
+    e = doptelem(e, GOALvalue);
+    int lat = SLbottom;
+    if (e->Eoper == OPconst)
+    {   *pc = el_tolong(e);
+        lat = SLconst;
+    }
+    el_free(e);
+    return lat;
+}
+
+STATIC bool ssafoldable(unsigned op)
+{
+    switch (op)
+    {
+        case OPadd:
+        case OPmin:
+        case OPmul:
+        case OPand:
+        case OPor:
+        case OPxor:
+        case OPshl:
+        case OPshr:
+        case OPashr:
+        case OPeqeq:
+        case OPne:
+        case OPlt:
+        case OPle:
+        case OPgt:
+        case OPge:
+        case OPneg:
+        case OPcom:
+        case OPnot:
+        case OPbool:
+            return TRUE;
+    }
+    return OTconv(op) != 0;
+}
+
+/*************************
+ * Evaluate e with the values in the lattice.
+ */
+
+STATIC int ssaeval(elem *e, targ_llong *pc)
+{
+    tym_t ty = tybasic(e->Ety);
+    if (!tyintegral(ty) || tysize(ty) > 8)
+        return SLbottom;
+
+    unsigned op = e->Eoper;
+    if (op == OPconst)
+    {   *pc = el_tolong(e);
+        return SLconst;
+    }
+    if (op == OPvar)
+    {
+        unsigned *pu = ssausetab->in(e);
+        if (!pu)
+            return SLbottom;
+        SsaVal *v = &ssavals[ssauses[*pu].val];
+        *pc = v->c;
+        return v->lat;
+    }
+    if (!ssafoldable(op))
+        return SLbottom;
+
+    targ_llong c1, c2 = 0;
+    int lat = ssaeval(e->E1, &c1);
+    if (lat == SLbottom)
+        return SLbottom;
+    tym_t ty2 = 0;
+    if (OTbinary(op))
+    {
+        int lat2 = ssaeval(e->E2, &c2);
+        if (lat2 == SLbottom)
+            return SLbottom;
+        if (lat2 == SLtop)
+            lat = SLtop;
+        ty2 = e->E2->Ety;
+    }
+    if (lat == SLtop)
+        return SLtop;
+    return ssafold(op, e->Ety, e->E1->Ety, c1, ty2, c2, pc);
+}
+
+STATIC int ssaevaldef(SsaVal *v, targ_llong *pc)
+{
+    elem *e = v->e;
+    unsigned op;
+    switch (e->Eoper)
+    {
+        case OPeq:
+            if (tysize(e->E2->Ety) != tysize(e->E1->Ety))
+                return SLbottom;
+            return ssaeval(e->E2, pc);
+
+        case OPaddass:
+        case OPminass:
+        case OPmulass:
+        case OPandass:
+        case OPorass:
+        case OPxorass:
+        case OPshlass:
+        case OPshrass:
+        case OPashrass:
+            op = opeqtoop(e->Eoper);
+            break;
+
+        case OPpostinc:
+            op = OPadd;
+            break;
+
+        case OPpostdec:
+            op = OPmin;
+            break;
+
+        case OPnegass:
+            op = OPneg;
+            break;
+
+        default:
+            return SLbottom;
+    }
+
+    SsaVal *p = &ssavals[v->prev];
+    if (p->lat == SLbottom)
+        return SLbottom;
+    targ_llong c2 = 0;
+    tym_t ty2 = 0;
+    int lat = p->lat;
+    if (OTbinary(op))
+    {
+        int lat2 = ssaeval(e->E2, &c2);
+        if (lat2 == SLbottom)
+            return SLbottom;
+        if (lat2 == SLtop)
+            lat = SLtop;
+        ty2 = e->E2->Ety;
+    }
+    if (lat == SLtop)
+        return SLtop;
+    return ssafold(op, e->Ety, e->E1->Ety, p->c, ty2, c2, pc);
+}
+
+/*************************
+ * Is the edge from block p to block s executable?
+ */
+
+STATIC bool ssaedge(block *p, block *s)
+{
+    unsigned i = p->Bdfoidx;
+    if (!ssaexec[i] || ssaout[i] == SOnone)
+        return FALSE;
+    return ssaout[i] == SOall || list_block(list_nth(p->Bsucc, ssaout[i])) == s;
+}
+
+STATIC int ssaevalval(SsaVal *v, targ_llong *pc)
+{
+    int lat = SLtop;
+    switch (v->kind)
+    {
+        case SVentry:
+            return SLbottom;
+
+        case SVphi:
+        {
+            block *b = dfo[v->b];
+            unsigned k = 0;
+            for (list_t bl = b->Bpred; bl; bl = list_next(bl), k++)
+            {
+                block *p = list_block(bl);
+                unsigned op = ssaops[v->ops + k];
+                if (op && ssaindfo(p) && ssaedge(p, b))
+                    lat = ssameet(lat, pc, ssavals[op].lat, ssavals[op].c);
+            }
+            return lat;
+        }
+
+        case SVmerge:
+            for (unsigned k = 0; k < v->nops; k++)
+            {
+                unsigned op = ssaops[v->ops + k];
+                lat = ssameet(lat, pc, ssavals[op].lat, ssavals[op].c);
+            }
+            return lat;
+
+        case SVdef:
+            return ssaevaldef(v, pc);
+
+        case SVcond:
+            return ssaeval(v->e, pc);
+    }
+    assert(0);
+    return SLbottom;
+}
+
+STATIC void ssapush(unsigned v)
+{
+    if (!(ssavals[v].flags & SSAinwork))
+    {
+        ssavals[v].flags |= SSAinwork;
+        ssawork[ssaworktop++] = v;
+    }
+}
+
+STATIC void ssaexecblock(unsigned i)
+{
+    if (ssaexec[i])
+    {   // A new edge only changes the phis
+        for (unsigned p = ssaphis[i]; p; p = ssavals[p].next)
+            ssapush(p);
+    }
+    else
+    {
+        ssaexec[i] = TRUE;
+        ssablkwork[ssablkworktop++] = i;
+    }
+}
+
+/*************************
+ * Set which successors of dfo[i] are executable.
+ */
+
+STATIC void ssasetout(unsigned i, int out)
+{
+    if (ssaout[i] == out)
+        return;
+    ssaout[i] = out;
+    block *b = dfo[i];
+    for (list_t bl = b->Bsucc; bl; bl = list_next(bl))
+    {
+        block *s = list_block(bl);
+        if (ssaindfo(s) && ssaedge(b, s))
+            ssaexecblock(s->Bdfoidx);
+    }
+}
+
+/*************************
+ * Sparse conditional constant propagation, see Wegman & Zadeck,
+ * "Constant Propagation with Conditional Branches".
+ */
+
+STATIC void ssasccp()
+{
+    ssawork = (unsigned *) util_calloc(sizeof(unsigned), ssavaltop);
+    ssaworktop = 0;
+    ssablkwork = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    ssablkworktop = 0;
+    ssaexecblock(0);
+
+    while (1)
+    {
+        if (ssablkworktop)
+        {
+            unsigned i = ssablkwork[--ssablkworktop];
+            for (unsigned p = ssaphis[i]; p; p = ssavals[p].next)
+                ssapush(p);
+            for (unsigned v = ssafirst[i]; v < ssalast[i]; v++)
+                ssapush(v);
+            if (!ssacond[i])
+                ssasetout(i, SOall);
+            continue;
+        }
+        if (!ssaworktop)
+            break;
+
+        unsigned v = ssawork[--ssaworktop];
+        SsaVal *sv = &ssavals[v];
+        sv->flags &= ~SSAinwork;
+        if (!ssaexec[sv->b])
+            continue;
+
+        targ_llong c = 0;
+        int lat = ssaevalval(sv, &c);
+        lat = ssameet(lat, &c, sv->lat, sv->c);     // only go down the lattice
+        if (lat == sv->lat && (lat != SLconst || c == sv->c))
+            continue;
+        sv->lat = lat;
+        sv->c = c;
+
+        for (unsigned l = sv->users; l; l = ssalinks[l].next)
+            ssapush(ssalinks[l].val);
+        if (sv->kind == SVcond)
+            ssasetout(sv->b, lat == SLbottom ? SOall : c ? 0 : 1);
+    }
+
+    util_free(ssablkwork);
+}
+
+/*************************
+ * Replace uses of constants with the constant.
+ */
+
+STATIC void ssareplace()
+{
+    for (unsigned u = 1; u < ssausetop; u++)
+    {
+        SsaUse *pu = &ssauses[u];
+        SsaVal *v = &ssavals[pu->val];
+        if (!ssaexec[pu->b] || v->lat != SLconst)
+            continue;
+
+        elem *e = pu->e;
+        tym_t ty = e->Ety;
+        elem *ec = el_long(ty, v->c);
+#ifdef DEBUG
+        if (debugc)
+        {   dbg_printf("ssa const prop (");
+            WReqn(e);
+            dbg_printf(" replaced by ");
+            WReqn(ec);
+            dbg_printf(")\n");
+        }
+#endif
+        el_copy(e, ec);
+        e->Ety = ty;                    // retain original type
+        el_free(ec);
+        pu->val = 0;
+        go.changes++;
+    }
+}
+
+STATIC void ssalive(unsigned v)
+{
+    if (v && !(ssavals[v].flags & SSAlive))
+    {
+        ssavals[v].flags |= SSAlive;
+        ssawork[ssaworktop++] = v;
+    }
+}
+
+/*************************
+ * Remove the assignments whose value is not used.
+ */
+
+STATIC void ssadeadass()
+{
+    unsigned u, v;
+
+    ssaworktop = 0;
+    for (u = 1; u < ssausetop; u++)
+    {
+        if (!ssauses[u].owner)
+            ssalive(ssauses[u].val);
+    }
+    for (v = 1; v < ssavaltop; v++)
+    {
+        SsaVal *sv = &ssavals[v];
+        if (sv->kind == SVcond || sv->kind == SVdef && !(sv->flags & SSAremovable))
+            ssalive(v);
+    }
+
+    while (ssaworktop)
+    {
+        SsaVal *sv = &ssavals[ssawork[--ssaworktop]];
+        switch (sv->kind)
+        {
+            case SVphi:
+            case SVmerge:
+                for (unsigned k = 0; k < sv->nops; k++)
+                    ssalive(ssaops[sv->ops + k]);
+                break;
+
+            case SVdef:
+                if (sv->e->Eoper != OPeq)
+                    ssalive(sv->prev);
+                /* FALL-THROUGH */
+            case SVcond:
+                for (u = sv->uses; u; u = ssauses[u].next)
+                    ssalive(ssauses[u].val);
+                break;
+        }
+    }
+
+    for (v = 1; v < ssavaltop; v++)
+    {
+        SsaVal *sv = &ssavals[v];
+        if (sv->kind == SVdef && (sv->flags & (SSAremovable | SSAlive)) == SSAremovable)
+        {
+#ifdef DEBUG
+            if (debugc)
+            {   dbg_printf("ssa dead assignment (");
+                WReqn(sv->e);
+                dbg_printf(")\n");
+            }
+#endif
+            elimass(sv->e);
+            go.changes++;
+        }
+    }
+}
+
+/*************************************
+ * Constant propagation and dead assignment elimination on the SSA form
+ * of the function, before constprop() and rmdeadass().
+ * Constants are propagated through the branches they decide, which
+ * the reaching definitions of constprop() do not do.
+ * Only the variables that qualify for SSA form are done, constprop()
+ * and rmdeadass() are still needed for the others.
+ * Returns:
+ *      FALSE if the function was left alone
+ */
+
+bool ssaopt()
+{
+    unsigned i;
+
+    cmes("ssaopt()\n");
+    compdfo();
+    if (blockinit() || dfo[0]->Bpred)
+        return FALSE;
+    for (i = 0; i < dfotop; i++)
+    {
+        block *b = dfo[i];
+        switch (b->BC)
+        {
+            case BCgoto:
+            case BCiftrue:
+            case BCret:
+            case BCretexp:
+            case BCexit:
+            case BCswitch:
+            case BCifthen:
+            case BCjmptab:
+                break;
+
+            default:
+                return FALSE;           // exception handling
+        }
+        if (b->Btry)
+            return FALSE;
+    }
+
+    // Pick the variables to put in SSA form
+    ssansyms = globsym.top;
+    if (!ssansyms)
+        return FALSE;
+    ssacand = (bool *) util_calloc(sizeof(bool), ssansyms);
+    for (SYMIDX si = 0; si < ssansyms; si++)
+    {
+        symbol *s = globsym.tab[si];
+        tym_t ty = s->ty();
+        ssacand[si] = symbol_isintab(s) && s->Sflags & SFLunambig &&
+            !(s->Sflags & SFLlivexit) && !(ty & mTYvolatile) &&
+            tyintegral(ty) && tysize(ty) <= 8;
+    }
+    ssafail = FALSE;
+    for (i = 0; i < dfotop; i++)
+    {
+        if (dfo[i]->Belem)
+            ssascan(dfo[i]->Belem, 0);
+    }
+    SYMIDX ncand = 0;
+    for (SYMIDX si = 0; si < ssansyms; si++)
+        ncand += ssacand[si];
+    if (ssafail || !ncand)
+    {
+        util_free(ssacand);
+        return FALSE;
+    }
+
+    compdom();
+    unsigned *idom = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    compidom(idom);
+    ssachild = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    ssasib = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    for (i = dfotop; --i > 0;)
+    {
+        ssasib[i] = ssachild[idom[i]];
+        ssachild[idom[i]] = i;
+    }
+
+    vec_t *defs = (vec_t *) util_calloc(sizeof(vec_t), dfotop);
+    for (i = 0; i < dfotop; i++)
+    {
+        defs[i] = vec_calloc(ssansyms);
+        if (dfo[i]->Belem)
+            ssaaccumdefs(dfo[i]->Belem, defs[i]);
+    }
+
+    ssavals = NULL;
+    ssavalmax = 0;
+    ssavaltop = 0;
+    ssanewval(SVentry, 0, 0);           // 0 is not a value
+    ssauses = NULL;
+    ssausemax = 0;
+    ssausetop = 1;
+    ssalinks = NULL;
+    ssalinkmax = 0;
+    ssalinktop = 1;
+    ssaops = NULL;
+    ssaopmax = 0;
+    ssaoptop = 0;
+    ssaundotop = 0;
+    ssausetab = new HashTab<elem *, unsigned, SsaTraits>();
+    ssacur = (unsigned *) util_calloc(sizeof(unsigned), ssansyms);
+    ssastamp = (unsigned *) util_calloc(sizeof(unsigned), ssansyms);
+    ssastampgen = 0;
+    ssaphis = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    ssafirst = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    ssalast = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+    ssacond = (unsigned *) util_calloc(sizeof(unsigned), dfotop);
+
+    // Build the SSA form
+    for (SYMIDX si = 0; si < ssansyms; si++)
+    {
+        if (ssacand[si])
+            ssacur[si] = ssanewval(SVentry, si, 0);
+    }
+    ssaplacephis(idom, defs);
+    ssarename(0);
+
+    if (!ssafail)
+    {
+        ssaexec = (bool *) util_calloc(sizeof(bool), dfotop);
+        ssaout = (int *) util_calloc(sizeof(int), dfotop);
+        for (i = 0; i < dfotop; i++)
+            ssaout[i] = SOnone;
+        ssasccp();
+        ssareplace();
+        ssadeadass();
+        util_free(ssawork);
+        util_free(ssaout);
+        util_free(ssaexec);
+    }
+
+    util_free(ssacond);
+    util_free(ssalast);
+    util_free(ssafirst);
+    util_free(ssaphis);
+    util_free(ssastamp);
+    util_free(ssacur);
+    delete ssausetab;
+    util_free(ssaundo);
+    ssaundo = NULL;
+    ssaundomax = 0;
+    util_free(ssaops);
+    util_free(ssalinks);
+    util_free(ssauses);
+    util_free(ssavals);
+    for (i = 0; i < dfotop; i++)
+        vec_free(defs[i]);
+    util_free(defs);
+    util_free(ssasib);
+    util_free(ssachild);
+    util_free(idom);
+    util_free(ssacand);
+    return !ssafail;
+}
+
+#endif
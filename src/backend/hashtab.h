@@ -0,0 +1,151 @@
+// Compiler implementation of the D programming language
+// Copyright (c) 2016 by Digital Mars
+// All Rights Reserved
+// http://www.digitalmars.com
+// Distributed under the Boost Software License, Version 1.0.
+// http://www.boost.org/LICENSE_1_0.txt
+// https://github.com/dlang/dmd/blob/master/src/backend/hashtab.h
+
+
+#ifndef HASHTAB_H
+#define HASHTAB_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tinfo.h"
+
+/**************************************************
+ * Hash table mapping Key to Value, with the key type known at
+ * compile time so hashing and comparing keys gets inlined,
+ * unlike AArray which goes through TypeInfo for each probe.
+ *
+ * Uses open addressing with linear probing in a power of 2 sized
+ * table kept at most half full. Entries cannot be removed.
+ * Key and Value must be POD types.
+ *
+ * Traits provides:
+ *      static hash_t hash(const Key& key);
+ *      static bool equals(const Key& key1, const Key& key2);
+ */
+
+template<class Key, class Value, class Traits>
+struct HashTab
+{
+    HashTab()
+    {
+        entries = NULL;
+        dim = 0;
+        nodes = 0;
+    }
+
+    ~HashTab()
+    {
+        delete [] entries;
+    }
+
+    size_t length()
+    {
+        return nodes;
+    }
+
+    /*************************************************
+     * Get pointer to value indexed by key.
+     * Add entry for key with a value of 0 if it is not already there.
+     */
+
+    Value *get(const Key& key)
+    {
+        if (2 * (nodes + 1) > dim)
+            grow();
+        hash_t hash = hashOf(key);
+        Entry *e = lookup(key, hash);
+        if (!e->hash)
+        {
+            e->hash = hash;
+            e->key = key;
+            memset(&e->value, 0, sizeof(Value));
+            nodes++;
+        }
+        return &e->value;
+    }
+
+    /*************************************************
+     * Determine if key is in the table.
+     * Returns:
+     *  NULL    not in the table
+     *  !=NULL  in the table, return pointer to value
+     */
+
+    Value *in(const Key& key)
+    {
+        if (!nodes)
+            return NULL;
+        Entry *e = lookup(key, hashOf(key));
+        return e->hash ? &e->value : NULL;
+    }
+
+  private:
+    struct Entry
+    {
+        hash_t hash;            // 0 for an unused entry
+        Key key;
+        Value value;
+    };
+
+    Entry *entries;
+    size_t dim;                 // number of entries, power of 2
+    size_t nodes;               // number of used entries
+
+    static hash_t hashOf(const Key& key)
+    {
+        hash_t hash = Traits::hash(key);
+        return hash ? hash : 1;
+    }
+
+    /* Spread the high bits of hash into the low bits that pick the entry.
+     */
+    static size_t slot(hash_t hash, size_t mask)
+    {
+        hash ^= (hash >> 15) ^ (hash >> 7);
+        return hash & mask;
+    }
+
+    /* Find the entry for key, or the unused entry where it goes.
+     */
+    Entry *lookup(const Key& key, hash_t hash)
+    {
+        size_t mask = dim - 1;
+        for (size_t i = slot(hash, mask); 1; i = (i + 1) & mask)
+        {
+            Entry *e = &entries[i];
+            if (!e->hash || (e->hash == hash && Traits::equals(e->key, key)))
+                return e;
+        }
+    }
+
+    void grow()
+    {
+        Entry *olde = entries;
+        size_t olddim = dim;
+
+        dim = dim ? dim * 2 : 16;
+        entries = new Entry[dim];
+        memset(entries, 0, dim * sizeof(Entry));
+
+        // Reuse the stored hashes, keys are not hashed again
+        size_t mask = dim - 1;
+        for (size_t j = 0; j < olddim; j++)
+        {
+            if (!olde[j].hash)
+                continue;
+            size_t i = slot(olde[j].hash, mask);
+            while (entries[i].hash)
+                i = (i + 1) & mask;
+            entries[i] = olde[j];
+        }
+        delete [] olde;
+    }
+};
+
+#endif
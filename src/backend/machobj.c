@@ -679,7 +679,7 @@ void Obj::term(const char *objfilename)
 
     if (configv.addlinenumbers)
     {
-        dwarf_termfile();
+        dwarf_termfile(objfilename);
     }
 
 #if SCPP
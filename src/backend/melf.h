@@ -116,6 +116,7 @@ typedef struct
         #define SHF_EXECINSTR   (1 << 2)    /* Executable machine instructions*/
         #define SHF_GROUP       (1 << 9)    /* Member of a section group */
         #define SHF_TLS         (1 << 10)   /* Thread local */
+        #define SHF_COMPRESSED  (1 << 11)   /* Data starts with an Elf32_Chdr/Elf64_Chdr */
         #define SHF_MASKPROC    0xf0000000  /* Mask for processor-specific */
   Elf32_Addr   sh_addr;                /* Starting virtual memory address */
   Elf32_Off   sh_offset;              /* Offset to section in file */
@@ -126,6 +127,15 @@ typedef struct
   Elf32_Word   sh_entsize;             /* Size of fixed size section entries */
 } Elf32_Shdr;
 
+// Header of SHF_COMPRESSED section data
+typedef struct
+{
+  Elf32_Word   ch_type;                /* Compression algorithm */
+        #define ELFCOMPRESS_ZLIB 1          /* zlib format */
+  Elf32_Word   ch_size;                /* Size of uncompressed data */
+  Elf32_Word   ch_addralign;           /* Alignment of uncompressed data */
+} Elf32_Chdr;
+
 // Special Section Header Table Indices
 #define SHN_UNDEF       0               /* Undefined section */
 #define SHN_LORESERVE   0xff00          /* Start of reserved indices */
@@ -331,6 +341,13 @@ typedef struct {
     Elf64_Xword sh_entsize;
 } Elf64_Shdr;
 
+typedef struct {
+    Elf64_Word  ch_type;
+    Elf64_Word  ch_reserved;
+    Elf64_Xword ch_size;
+    Elf64_Xword ch_addralign;
+} Elf64_Chdr;
+
 typedef struct {
     Elf64_Word  p_type;
     Elf64_Word  p_flags;
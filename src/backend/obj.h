@@ -104,8 +104,13 @@ struct Obj
 
 struct ElfObj : Obj
 {
+    static void term(const char *objfilename, FILE *fd);
     static int getsegment(const char *name, const char *suffix,
         int type, int flags, int align);
+    static int getgroupsegment(const char *name, const char *signature,
+        int type, int flags, int align);
+    static void writedwo(const char *filename, int nsections,
+        const char **names, Outbuffer **bufs);
     static void addrel(int seg, targ_size_t offset, unsigned type,
                        unsigned symidx, targ_size_t val);
     static size_t writerel(int targseg, size_t offset, unsigned type,
@@ -584,6 +584,9 @@ public:
 
     FuncDeclarations *inlinedNestedCallees;
 
+    // calls this function is passed to as an argument that is not scope
+    EscapeArgs *escapeArgs;
+
     unsigned flags;                     // FUNCFLAGxxxxx
 
     FuncDeclaration(Loc loc, Loc endloc, Identifier *id, StorageClass storage_class, Type *type);
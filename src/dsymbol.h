@@ -297,6 +297,8 @@ private:
 
     BitArray accessiblePackages;
 
+    AA *importSearchCache;      // memoized searches of importedScopes
+
 public:
     ScopeDsymbol();
     ScopeDsymbol(Identifier *id);
@@ -56,6 +56,9 @@ elem *toElemDtor(Expression *e, IRState *irs);
 elem *toElemStructLit(StructLiteralExp *sle, IRState *irs, TOK op, Symbol *sym, bool fillHoles);
 Symbol *toStringSymbol(const char *str, size_t len, size_t sz);
 Symbol *toStringSymbol(StringExp *se);
+Symbol *toImmutableArray(ArrayLiteralExp *ale);
+void Expression_toDt(Expression *e, DtBuilder *dtb);
+bool allocationEscapes(Expression *e);
 void toObjFile(Dsymbol *ds, bool multiobj);
 Symbol *toModuleAssert(Module *m);
 Symbol *toModuleUnittest(Module *m);
@@ -1457,9 +1460,12 @@ elem *toElem(Expression *e, IRState *irs)
                 elem *ezprefix = NULL;
                 elem *ez = NULL;
 
-                if (ne->allocator || ne->onstack)
+                // Instances that do not escape go on the stack, too
+                bool onstack = ne->onstack || (ne->escapeArg && !allocationEscapes(ne));
+
+                if (ne->allocator || onstack)
                 {
-                    if (ne->onstack)
+                    if (onstack)
                     {
                         /* Create an instance of the class on the stack,
                          * and call it stmp.
@@ -4830,6 +4836,8 @@ elem *toElem(Expression *e, IRState *irs)
                         elem *ea = el_bin(OPcall,TYvoid,el_var(sassert),
                             el_long(TYint, ie->loc.linnum));
                         eb = el_bin(OPoror,TYvoid,n2x,ea);
+                        eb->Eflags |= EFLAGS_arraybounds;   // opt_arraybounds() may remove it
+                        el_setLoc(eb, ie->loc);
                     }
                 }
 
@@ -4899,6 +4907,23 @@ elem *toElem(Expression *e, IRState *irs)
                 e = ExpressionsToStaticArray(ale->loc, ale->elements, &stmp, 0, ale->basis);
                 e = el_combine(e, el_ptr(stmp));
             }
+            else if (ale->escapeArg && !allocationEscapes(ale))
+            {
+                /* The array does not escape, so it need not be on the GC heap.
+                 * Constant immutable arrays go in read-only data,
+                 * others in a temporary on the stack.
+                 */
+                Symbol *stmp = NULL;
+                if (tb->nextOf()->isImmutable())
+                    stmp = toImmutableArray(ale);
+                if (stmp)
+                    e = el_ptr(stmp);
+                else
+                {
+                    e = ExpressionsToStaticArray(ale->loc, ale->elements, &stmp, 0, ale->basis);
+                    e = el_combine(e, el_ptr(stmp));
+                }
+            }
             else if (ale->elements)
             {
                 /* Instead of passing the initializers on the stack, allocate the
@@ -5676,6 +5701,42 @@ Symbol *toStringSymbol(StringExp *se)
     return si;
 }
 
+/*******************************************************
+ * Write array literal with constant scalar elements to read-only data.
+ * Returns:
+ *      Symbol, or NULL if not all elements are constants
+ */
+
+Symbol *toImmutableArray(ArrayLiteralExp *ale)
+{
+    size_t dim = ale->elements->dim;
+    for (size_t i = 0; i < dim; i++)
+    {
+        Expression *el = (*ale->elements)[i];
+        if (!el)
+            el = ale->basis;
+        if (!el->type->isscalar() ||
+            (el->op != TOKint64 && el->op != TOKfloat64 && el->op != TOKcomplex80))
+            return NULL;
+    }
+
+    Type *telem = ale->type->toBasetype()->nextOf();
+    Symbol *si = symbol_generate(SCstatic, Type_toCtype(telem->sarrayOf(dim)));
+
+    DtBuilder dtb;
+    for (size_t i = 0; i < dim; i++)
+    {
+        Expression *el = (*ale->elements)[i];
+        Expression_toDt(el ? el : ale->basis, &dtb);
+    }
+    si->Sdt = dtb.finish();
+
+    si->Sfl = FLdata;
+    out_readonly(si);
+    outdata(si);
+    return si;
+}
+
 /******************************************************
  * Return an elem that is the file, line, and function suitable
  * for insertion into the parameter list.
@@ -50,6 +50,7 @@ class StringExp;
 class ArrayExp;
 class SliceExp;
 struct UnionExp;
+struct EscapeArg;
 
 void initPrecedence();
 
@@ -416,6 +417,7 @@ public:
     Expression *basis;
     Expressions *elements;
     OwnedBy ownedByCtfe;
+    EscapeArg *escapeArg;       // if !NULL, only passed to this parameter
 
     ArrayLiteralExp(Loc loc, Expressions *elements);
     ArrayLiteralExp(Loc loc, Expression *e);
@@ -556,6 +558,7 @@ public:
     CtorDeclaration *member;    // constructor function
     NewDeclaration *allocator;  // allocator function
     int onstack;                // allocate on stack
+    EscapeArg *escapeArg;       // if !NULL, only passed to this parameter
 
     NewExp(Loc loc, Expression *thisexp, Expressions *newargs,
         Type *newtype, Expressions *arguments);
@@ -40,7 +40,11 @@ struct Param
     bool link;          // perform link
     bool dll;           // generate shared dynamic library
     bool lib;           // write library file instead of object file(s)
+    bool libthin;       // write thin library referring to the object files
+    bool libupdate;     // only replace the changed members of an existing library
+    bool linkinmemory;  // pass the object file to the linker without writing it to disk
     bool multiobj;      // break one object file into multiple ones
+    unsigned multiobjgroup; // max number of deferred symbols per object file with multiobj, 0 means 1
     bool oneobj;        // write one object file instead of multiple ones
     bool trace;         // insert profiling hooks
     bool tracegc;       // instrument calls to 'new'
@@ -50,9 +54,13 @@ struct Param
     char vgc;           // identify gc usage
     bool vfield;        // identify non-mutable field variables
     bool vcomplex;      // identify complex/imaginary type usage
+    bool vbounds;       // identify array bounds checks removed by the optimizer
+    bool vstats;        // print statistics about internal compiler caches
     char symdebug;      // insert debug symbolic information
     bool alwaysframe;   // always emit standard stack frame
     bool optimize;      // run optimizer
+    bool ssa;           // use SSA form in the optimizer
+    bool gvn;           // use global value numbering in the optimizer
     bool map;           // generate linker .map file
     bool is64bit;       // generate 64 bit code
     bool isLP64;        // generate code for LP64
@@ -73,6 +81,11 @@ struct Param
     bool useIn;         // generate precondition checks
     bool useOut;        // generate postcondition checks
     bool stackstomp;    // add stack stomping code
+    bool compressdebug; // compress debug sections
+    bool debugtypes;    // put struct debug info in type units
+    bool splitdebug;    // put debug info in a separate .dwo file
+    bool funcsections;  // put each function in its own section
+    bool datasections;  // put each global variable in its own section
     bool useSwitchError; // check for switches without a default
     bool useUnitTests;  // generate unittest code
     bool useInline;     // inline expand functions
@@ -150,6 +163,7 @@ struct Param
     const char *resfile;
     const char *exefile;
     const char *mapfile;
+    const char *symorder;   // trace.def to write a symbol ordering file from
 };
 
 struct Compiler
@@ -93,7 +93,13 @@ void obj_append(Dsymbol *s)
 
 void obj_write_deferred(Library *library)
 {
-    for (size_t i = 0; i < obj_symbols_towrite.dim; i++)
+    /* Put up to global.params.multiobjgroup deferred symbols from the same
+     * module in each object file. Fewer objects are cheaper to generate,
+     * but the linker can only leave out a whole object, not a part of it.
+     */
+    size_t ngroup = global.params.multiobjgroup ? global.params.multiobjgroup : 1;
+
+    for (size_t i = 0; i < obj_symbols_towrite.dim; )
     {
         Dsymbol *s = obj_symbols_towrite[i];
         Module *m = s->getModule();
@@ -111,6 +117,12 @@ void obj_write_deferred(Library *library)
             assert(mname);
         }
 
+        // Symbols [i .. iend) go into this object file
+        size_t iend = i + 1;
+        while (iend < obj_symbols_towrite.dim && iend - i < ngroup &&
+               obj_symbols_towrite[iend]->getModule() == m)
+            iend++;
+
         obj_start(mname);
 
         static int count;
@@ -128,7 +140,8 @@ void obj_write_deferred(Library *library)
             // it doesn't make sense to make up a module if we don't know where to put the symbol
             //  so output it into it's own object file without ModuleInfo
             objmod->initfile(idstr, NULL, mname);
-            toObjFile(s, false);
+            for (size_t j = i; j < iend; j++)
+                toObjFile(obj_symbols_towrite[j], false);
             objmod->termfile();
         }
         else
@@ -138,7 +151,8 @@ void obj_write_deferred(Library *library)
 
             Module *md = Module::create(mname, id, 0, 0);
             md->members = Dsymbols_create();
-            md->members->push(s);   // its only 'member' is s
+            for (size_t j = i; j < iend; j++)
+                md->members->push(obj_symbols_towrite[j]);   // its only 'members' are the symbols
             md->doppelganger = 1;       // identify this module as doppelganger
             md->md = m->md;
             md->aimports.push(m);       // it only 'imports' m
@@ -164,6 +178,8 @@ void obj_write_deferred(Library *library)
         //printf("writing '%s'\n", fname);
         File *objfile = File::create(fname);
         obj_end(library, objfile);
+
+        i = iend;
     }
     obj_symbols_towrite.dim = 0;
 }
@@ -256,10 +272,41 @@ void obj_start(char *srcfile)
 void obj_end(Library *library, File *objfile)
 {
     const char *objfilename = objfile->name->toChars();
-    objmod->term(objfilename);
+    bool streamed = false;
+#if TARGET_LINUX || TARGET_FREEBSD || TARGET_OPENBSD || TARGET_SOLARIS
+    if (!library)
+    {
+        /* Stream the object file to disk rather than assembling
+         * the whole image in objbuf first.
+         */
+        ensurePathToNameExists(Loc(), objfilename);
+        FILE *fp = fopen(objfilename, "wb");
+        if (!fp)
+        {
+            error(Loc(), "Error writing file '%s'", objfilename);
+            fatal();
+        }
+        //printf("write obj %s\n", objfilename);
+        ElfObj::term(objfilename, fp);
+        if (ferror(fp) | fclose(fp))
+        {
+            error(Loc(), "Error writing file '%s'", objfilename);
+            fatal();
+        }
+        streamed = true;
+    }
+    else
+#endif
+        objmod->term(objfilename);
     delete objmod;
     objmod = NULL;
 
+    if (streamed)
+    {
+        objbuf.setsize(0);      // keep the buffer for the next object file
+        return;
+    }
+
     if (library)
     {
         // Transfer image to library
@@ -66,6 +66,8 @@ public:
     static Dsymbols deferred2;  // deferred Dsymbol's needing semantic2() run on them
     static Dsymbols deferred3;  // deferred Dsymbol's needing semantic3() run on them
     static unsigned dprogress;  // progress resolving the deferred list
+    static int searchNesting;   // number of nested Module::search() in progress
+    static int searchCutoff;    // lowest insearch of a module skipped by search()
     static void init();
 
     static AggregateDeclaration *moduleinfo;
@@ -44,11 +44,19 @@ void out_config_init(
         bool nofloat,   // do not pull in floating point code
         bool verbose,   // verbose compile
         bool optimize,  // optimize code
+        bool ssa,       // use SSA form in the optimizer
+        bool gvn,       // use global value numbering in the optimizer
         int symdebug,   // add symbolic debug information
                         // 1: D
                         // 2: fake it with C symbolic debug info
         bool alwaysframe,       // always create standard function frame
-        bool stackstomp         // add stack stomping code
+        bool stackstomp,        // add stack stomping code
+        bool compressdebug,     // compress debug sections
+        bool debugtypes,        // put struct debug info in type units
+        bool splitdebug,        // put debug info in a separate .dwo file
+        bool funcsections,      // put each function in its own section
+        bool datasections,      // put each global variable in its own section
+        bool vbounds            // list array bounds checks removed by the optimizer
         );
 
 void out_config_debug(
@@ -96,9 +104,17 @@ void backend_init()
         params->nofloat,
         params->verbose,
         params->optimize,
+        params->ssa,
+        params->gvn,
         params->symdebug,
         params->alwaysframe,
-        params->stackstomp
+        params->stackstomp,
+        params->compressdebug,
+        params->debugtypes,
+        params->splitdebug,
+        params->funcsections,
+        params->datasections,
+        params->vbounds
     );
 
 #ifdef DEBUG
@@ -213,7 +213,7 @@ else
 	FRONT_SRCS += objc_stubs.d
 endif
 
-ROOT_SRCS = $(addsuffix .d,$(addprefix $(ROOT)/,aav array file filename	\
+ROOT_SRCS = $(addsuffix .d,$(addprefix $(ROOT)/,aav array async file filename	\
 	longdouble man outbuffer port response rmem rootobject speller	\
 	stringtable))
 
@@ -237,12 +237,12 @@ GLUE_SRCS=$(addsuffix .d,backend irstate toelfdebug toctype gluelayer todt)
 
 DMD_SRCS=$(FRONT_SRCS) $(GLUE_SRCS)
 
-BACK_OBJS = go.o gdag.o gother.o gflow.o gloop.o var.o el.o \
+BACK_OBJS = go.o gdag.o gother.o gssa.o gflow.o gloop.o var.o el.o \
 	glocal.o os.o nteh.o evalu8.o cgcs.o \
 	rtlsym.o cgelem.o cgen.o cgreg.o out.o \
 	blockopt.o cg.o type.o dt.o \
 	debug.o code.o ee.o symbol.o \
-	cgcod.o cod5.o outbuf.o compress.o \
+	cgcod.o cod5.o outbuf.o compress.o deflate.o \
 	bcomplex.o aa.o ti_achar.o \
 	ti_pvoid.o pdata.o cv8.o backconfig.o \
 	divcoeff.o dwarf.o dwarfeh.o \
@@ -280,16 +280,16 @@ BACK_SRC = \
 	$C/el.h $C/iasm.h $C/rtlsym.h \
 	$C/bcomplex.c $C/blockopt.c $C/cg.c $C/cg87.c $C/cgxmm.c \
 	$C/cgcod.c $C/cgcs.c $C/cgcv.c $C/cgelem.c $C/cgen.c $C/cgobj.c \
-	$C/compress.c $C/cgreg.c $C/var.c $C/strtold.c \
+	$C/compress.c $C/deflate.c $C/cgreg.c $C/var.c $C/strtold.c \
 	$C/cgsched.c $C/cod1.c $C/cod2.c $C/cod3.c $C/cod4.c $C/cod5.c \
 	$C/code.c $C/symbol.c $C/debug.c $C/dt.c $C/ee.c $C/el.c \
 	$C/evalu8.c $C/go.c $C/gflow.c $C/gdag.c \
-	$C/gother.c $C/glocal.c $C/gloop.c $C/newman.c \
+	$C/gother.c $C/gssa.c $C/glocal.c $C/gloop.c $C/newman.c \
 	$C/nteh.c $C/os.c $C/out.c $C/outbuf.c $C/ptrntab.c $C/rtlsym.c \
 	$C/type.c $C/melf.h $C/mach.h $C/mscoff.h $C/bcomplex.h \
 	$C/outbuf.h $C/token.h $C/tassert.h \
 	$C/elfobj.c $C/cv4.h $C/dwarf2.h $C/exh.h $C/go.h \
-	$C/dwarf.c $C/dwarf.h $C/aa.h $C/aa.c $C/tinfo.h $C/ti_achar.c \
+	$C/dwarf.c $C/dwarf.h $C/aa.h $C/aa.c $C/hashtab.h $C/tinfo.h $C/ti_achar.c \
 	$C/ti_pvoid.c $C/platform_stub.c $C/code_x86.h $C/code_stub.h \
 	$C/machobj.c $C/mscoffobj.c \
 	$C/xmm.h $C/obj.h $C/pdata.c $C/cv8.c $C/backconfig.c $C/divcoeff.c \
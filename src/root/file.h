@@ -42,6 +42,12 @@ struct File
 
     bool read();
 
+    /* Read file, mapping it into memory if it is large,
+     * return true if error
+     */
+
+    bool mmapread();
+
     /* Write file, return true if error
      */
 
@@ -50,12 +56,9 @@ struct File
     /* Set buffer
      */
 
-    void setbuffer(void *buffer, size_t len)
-    {
-        this->buffer = (unsigned char *)buffer;
-        this->len = len;
-    }
+    void setbuffer(void *buffer, size_t len);   // releases a mapping made by mmapread()
 
+    void freebuffer();          // release buffer unless it is a reference
     void remove();              // delete file
 };
 
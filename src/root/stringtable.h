@@ -18,6 +18,7 @@
 #include "rmem.h"   // for d_size_t
 
 struct StringEntry;
+struct StringTableShard;
 
 // StringValue is a variable-length structure. It has neither proper c'tors nor a
 // factory method because the only thing which should be creating these is StringTable.
@@ -36,20 +37,18 @@ struct StringValue
 struct StringTable
 {
 private:
-    StringEntry *table;
-    size_t tabledim;
-
-    uint8_t **pools;
-    size_t npools;
-    size_t nfill;
-
-    size_t count;
+    StringTableShard *shards;
+    size_t nshards;
+    unsigned shardshift;
+    bool concurrent;
 
 public:
     void _init(d_size_t size = 0);
     void reset(d_size_t size = 0);
     ~StringTable();
 
+    void setConcurrent(bool concurrent);
+
     StringValue *lookup(const char *s, d_size_t len);
     StringValue *update(const char *s, d_size_t len);
 };
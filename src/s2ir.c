@@ -10,6 +10,7 @@
  */
 
 #include        <stdio.h>
+#include        <stdlib.h>
 #include        <string.h>
 #include        <time.h>
 
@@ -143,6 +144,441 @@ void incUsage(IRState *irs, Loc loc)
     }
 }
 
+/**************************************
+ * Perfect hash of the case strings of a string switch.
+ * The key of a string is computed from its length and the code units
+ * at pos[], counting from the start, or from the end for ~k. Positions
+ * past the end of a string are clamped to its last code unit, so
+ * strings must not be empty.
+ * Keys are spread over the buckets by K1, each bucket has a displacement
+ * added to the slot picked by K2, so that every case gets its own slot.
+ */
+
+#define SWITCH_HASH_MAXPOS      6       // max number of code units looked at
+#define SWITCH_HASH_MAXCAND     32      // max distance from either end looked at
+#define SWITCH_HASH_TRIES       16      // number of multipliers tried
+
+struct StringHash
+{
+    int pos[SWITCH_HASH_MAXPOS];
+    int npos;
+    unsigned K1, K2;            // multipliers
+    int gbits;                  // log2 of the number of buckets
+    int bits;                   // log2 of the number of slots
+    unsigned *disp;             // displacement for each bucket
+    int *slot;                  // case for each slot, -1 if empty
+};
+
+static unsigned stringKey(StringExp *se, int *pos, int npos)
+{
+    size_t len = se->numberOfCodeUnits();
+    unsigned key = (unsigned)len;
+    for (int i = 0; i < npos; i++)
+    {
+        size_t k;
+        if (pos[i] >= 0)
+            k = (size_t)pos[i] < len ? pos[i] : len - 1;
+        else
+            k = (size_t)~pos[i] < len ? len - 1 - ~pos[i] : 0;
+        key = key * 31 + se->charAt(k);
+    }
+    return key;
+}
+
+static int unsigned_cmp(const void *p1, const void *p2)
+{
+    unsigned u1 = *(const unsigned *)p1;
+    unsigned u2 = *(const unsigned *)p2;
+    return u1 < u2 ? -1 : u1 > u2;
+}
+
+/* Number of distinct keys of the strings, using tmp[] as scratch.
+ */
+static size_t distinctKeys(StringExp **strs, size_t n, int *pos, int npos, unsigned *tmp)
+{
+    for (size_t i = 0; i < n; i++)
+        tmp[i] = stringKey(strs[i], pos, npos);
+    qsort(tmp, n, sizeof(unsigned), &unsigned_cmp);
+    size_t distinct = 1;
+    for (size_t i = 1; i < n; i++)
+        distinct += tmp[i] != tmp[i - 1];
+    return distinct;
+}
+
+static int log2ceil(size_t n)
+{
+    int bits = 0;
+    while (((size_t)1 << bits) < n)
+        bits++;
+    return bits;
+}
+
+/* Fill in h->disp[] and h->slot[] for keys[], using h->K1 and h->K2.
+ * Returns:
+ *      false if the keys cannot all be given a slot
+ */
+static bool buildStringHash(StringHash *h, unsigned *keys, size_t n)
+{
+    size_t nbuckets = (size_t)1 << h->gbits;
+    size_t nslots = (size_t)1 << h->bits;
+    unsigned mask = (unsigned)nslots - 1;
+
+    // Sort the cases by bucket, largest bucket first
+    size_t *bucket = (size_t *)mem.xmalloc(n * sizeof(size_t));
+    size_t *count = (size_t *)mem.xcalloc(nbuckets, sizeof(size_t));
+    size_t *order = (size_t *)mem.xmalloc(n * sizeof(size_t));
+    for (size_t i = 0; i < n; i++)
+    {
+        bucket[i] = h->gbits ? (keys[i] * h->K1) >> (32 - h->gbits) : 0;
+        count[bucket[i]]++;
+    }
+    size_t norder = 0;
+    for (size_t c = n; c; c--)
+    {
+        for (size_t g = 0; g < nbuckets; g++)
+        {
+            if (count[g] != c)
+                continue;
+            for (size_t i = 0; i < n; i++)
+            {
+                if (bucket[i] == g)
+                    order[norder++] = i;
+            }
+        }
+    }
+    assert(norder == n);
+
+    for (size_t j = 0; j < nslots; j++)
+        h->slot[j] = -1;
+    memset(h->disp, 0, nbuckets * sizeof(unsigned));
+
+    bool ok = true;
+    for (size_t first = 0; ok && first < n; )
+    {
+        size_t g = bucket[order[first]];
+        size_t last = first + count[g];
+
+        // Find a displacement that puts all the bucket's cases in free slots
+        unsigned d;
+        for (d = 0; d < nslots; d++)
+        {
+            size_t i;
+            for (i = first; i < last; i++)
+            {
+                size_t k = order[i];
+                unsigned s = (((keys[k] * h->K2) >> (32 - h->bits)) + d) & mask;
+                if (h->slot[s] != -1)
+                    break;
+                h->slot[s] = k;
+            }
+            if (i == last)
+                break;
+            // Undo
+            while (i-- > first)
+                h->slot[(((keys[order[i]] * h->K2) >> (32 - h->bits)) + d) & mask] = -1;
+        }
+        if (d == nslots)
+            ok = false;
+        h->disp[g] = d;
+        first = last;
+    }
+
+    mem.xfree(order);
+    mem.xfree(count);
+    mem.xfree(bucket);
+    return ok;
+}
+
+/* Choose the code units to look at and the multipliers.
+ * Returns:
+ *      false if no perfect hash was found
+ */
+static bool findStringHash(StringHash *h, StringExp **strs, size_t n, size_t maxlen)
+{
+    unsigned *keys = (unsigned *)mem.xmalloc(n * sizeof(unsigned));
+    bool ok = false;
+
+    /* Greedily add the code unit that best tells the strings apart,
+     * until they all have different keys.
+     */
+    int ncand = (int)(maxlen < SWITCH_HASH_MAXCAND ? maxlen : SWITCH_HASH_MAXCAND);
+    h->npos = 0;
+    size_t distinct = distinctKeys(strs, n, h->pos, 0, keys);
+    while (distinct < n && h->npos < SWITCH_HASH_MAXPOS)
+    {
+        size_t best = distinct;
+        int bestpos = 0;
+        for (int c = 0; c < 2 * ncand; c++)
+        {
+            int p = c & 1 ? ~(c >> 1) : c >> 1;
+            h->pos[h->npos] = p;
+            size_t dk = distinctKeys(strs, n, h->pos, h->npos + 1, keys);
+            if (dk > best)
+            {
+                best = dk;
+                bestpos = p;
+            }
+        }
+        if (best == distinct)
+            break;              // no improvement
+        h->pos[h->npos++] = bestpos;
+        distinct = best;
+    }
+
+    if (distinct == n)
+    {
+        for (size_t i = 0; i < n; i++)
+            keys[i] = stringKey(strs[i], h->pos, h->npos);
+
+        h->bits = log2ceil(n) + 1;      // at most half full
+        h->gbits = log2ceil((n + 3) / 4);
+        h->disp = (unsigned *)mem.xmalloc(((size_t)1 << h->gbits) * sizeof(unsigned));
+        h->slot = (int *)mem.xmalloc(((size_t)1 << h->bits) * sizeof(int));
+
+        // Deterministic sequence of odd multipliers
+        unsigned seed = 0x9E3779B9;
+        for (int i = 0; !ok && i < SWITCH_HASH_TRIES; i++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            h->K1 = seed | 1;
+            seed = seed * 1664525 + 1013904223;
+            h->K2 = seed | 1;
+            ok = buildStringHash(h, keys, n);
+        }
+        if (!ok)
+        {
+            mem.xfree(h->slot);
+            mem.xfree(h->disp);
+        }
+    }
+
+    mem.xfree(keys);
+    return ok;
+}
+
+/* Generate the lookup of string sstr with perfect hash h of the
+ * n strings in strs[], which have case numbers index[].
+ */
+static elem *stringHashLookup(StringHash *hp, StringExp **strs, size_t *index, size_t n,
+        size_t minlen, size_t maxlen, Symbol *sstr, unsigned sz)
+{
+    StringHash &h = *hp;
+
+    /* Write the table of slots, each is:
+     *      size_t length;      // ~0 if empty
+     *      char *ptr;
+     *      size_t index;       // of case
+     */
+    unsigned ptrsize = Target::ptrsize;
+    size_t nslots = (size_t)1 << h.bits;
+    Symbol *stab = symbol_generate(SCstatic, type_static_array(nslots * 3, tstypes[TYsize_t]));
+    DtBuilder dtb;
+    for (size_t j = 0; j < nslots; j++)
+    {
+        int k = h.slot[j];
+        if (k == -1)
+        {
+            dtb.size(~(d_ulong)0);
+            dtb.size(0);
+            dtb.size(0);
+        }
+        else
+        {
+            dtb.size(strs[k]->numberOfCodeUnits());
+            dtb.xoff(toStringSymbol(strs[k]), 0);
+            dtb.size(index[k]);
+        }
+    }
+    stab->Sdt = dtb.finish();
+    stab->Sfl = FLdata;
+    out_readonly(stab);
+    outdata(stab);
+
+    Symbol *sdisp = NULL;
+    if (h.gbits)
+    {
+        size_t nbuckets = (size_t)1 << h.gbits;
+        sdisp = symbol_generate(SCstatic, type_static_array(nbuckets, tsuns));
+        DtBuilder dtbd;
+        for (size_t g = 0; g < nbuckets; g++)
+            dtbd.dword(h.disp[g]);
+        sdisp->Sdt = dtbd.finish();
+        sdisp->Sfl = FLdata;
+        out_readonly(sdisp);
+        outdata(sdisp);
+    }
+
+    tym_t tyc = sz == 1 ? TYuchar : sz == 2 ? TYushort : TYuint;
+    int oplen = I64 ? OP128_64 : OP64_32;
+    Symbol *skey = symbol_genauto(TYuint);
+    Symbol *sent = symbol_genauto(TYnptr);
+
+    // (sstr.length - minlen) <= (maxlen - minlen)
+    elem *einrange = el_bin(OPle, TYint,
+        el_bin(OPmin, TYsize_t, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, minlen)),
+        el_long(TYsize_t, maxlen - minlen));
+
+    // skey = length * 31 + code unit ...
+    elem *ekey = el_una(oplen, TYsize_t, el_var(sstr));
+    if (I64)
+        ekey = el_una(OP64_32, TYuint, ekey);
+    for (int i = 0; i < h.npos; i++)
+    {
+        // Offset of the code unit, clamped to the string
+        size_t k = h.pos[i] >= 0 ? h.pos[i] : ~h.pos[i];
+        elem *eoff;
+        if (h.pos[i] >= 0)
+            eoff = el_long(TYsize_t, k);
+        else
+            eoff = el_bin(OPmin, TYsize_t, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, k + 1));
+        if (k >= minlen)
+        {
+            elem *eclamp = h.pos[i] >= 0
+                ? el_bin(OPmin, TYsize_t, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, 1))
+                : el_long(TYsize_t, 0);
+            eoff = el_bin(OPcond, TYsize_t,
+                el_bin(OPgt, TYint, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, k)),
+                el_bin(OPcolon, TYsize_t, eoff, eclamp));
+        }
+        eoff = el_bin(OPmul, TYsize_t, eoff, el_long(TYsize_t, sz));
+        elem *ec = el_una(OPind, tyc, el_bin(OPadd, TYnptr, el_una(OPmsw, TYnptr, el_var(sstr)), eoff));
+        if (sz == 1)
+            ec = el_una(OPu8_16, TYushort, ec);
+        if (sz <= 2)
+            ec = el_una(OPu16_32, TYuint, ec);
+        ekey = el_bin(OPadd, TYuint, el_bin(OPmul, TYuint, ekey, el_long(TYuint, 31)), ec);
+    }
+    elem *ekeyeq = el_bin(OPeq, TYuint, el_var(skey), ekey);
+
+    // slot = (((skey * K2) >> (32 - bits)) + disp[(skey * K1) >> (32 - gbits)]) & mask
+    elem *eslot = el_bin(OPshr, TYuint,
+        el_bin(OPmul, TYuint, el_var(skey), el_long(TYuint, h.K2)),
+        el_long(TYint, 32 - h.bits));
+    elem *edisp;
+    if (h.gbits)
+    {
+        elem *eg = el_bin(OPshr, TYuint,
+            el_bin(OPmul, TYuint, el_var(skey), el_long(TYuint, h.K1)),
+            el_long(TYint, 32 - h.gbits));
+        if (I64)
+            eg = el_una(OPu32_64, TYsize_t, eg);
+        eg = el_bin(OPmul, TYsize_t, eg, el_long(TYsize_t, 4));
+        edisp = el_una(OPind, TYuint, el_bin(OPadd, TYnptr, el_ptr(sdisp), eg));
+    }
+    else
+        edisp = el_long(TYuint, h.disp[0]);
+    eslot = el_bin(OPand, TYuint, el_bin(OPadd, TYuint, eslot, edisp), el_long(TYuint, nslots - 1));
+    if (I64)
+        eslot = el_una(OPu32_64, TYsize_t, eslot);
+
+    // sent = &table[slot]
+    elem *eent = el_bin(OPadd, TYnptr, el_ptr(stab),
+        el_bin(OPmul, TYsize_t, eslot, el_long(TYsize_t, 3 * ptrsize)));
+    elem *eenteq = el_bin(OPeq, TYnptr, el_var(sent), eent);
+
+    // sent.length == sstr.length && memcmp(sstr.ptr, sent.ptr, sstr.length * sz) == 0
+    elem *elencmp = el_bin(OPeqeq, TYint,
+        el_una(OPind, TYsize_t, el_var(sent)),
+        el_una(oplen, TYsize_t, el_var(sstr)));
+    elem *ememcmp = el_param(el_una(OPmsw, TYnptr, el_var(sstr)),
+        el_una(OPind, TYnptr, el_bin(OPadd, TYnptr, el_var(sent), el_long(TYsize_t, ptrsize))));
+    ememcmp = el_bin(OPmemcmp, TYint, ememcmp,
+        el_bin(OPmul, TYsize_t, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, sz)));
+    ememcmp = el_bin(OPeqeq, TYint, ememcmp, el_long(TYint, 0));
+    elem *ematch = el_bin(OPandand, TYint, elencmp, ememcmp);
+
+    // inrange && (skey = ..., sent = ..., match) ? sent.index : -1
+    ematch = el_combine(el_combine(ekeyeq, eenteq), ematch);
+    elem *eindex = el_una(OPind, TYint, el_bin(OPadd, TYnptr, el_var(sent), el_long(TYsize_t, 2 * ptrsize)));
+    elem *er = el_bin(OPcond, TYint, el_bin(OPandand, TYint, einrange, ematch),
+        el_bin(OPcolon, TYint, eindex, el_long(TYint, -1)));
+
+    mem.xfree(h.slot);
+    mem.xfree(h.disp);
+    return er;
+}
+
+/**************************************
+ * Generate code that finds the case of a switch on a string
+ * without calling the runtime library.
+ * Params:
+ *      s = switch statement, cases sorted
+ *      econd = the string switched on
+ * Returns:
+ *      elem giving the index of the case, or -1 if none matches,
+ *      NULL if no perfect hash for the cases could be found
+ */
+
+static elem *switchStringHash(SwitchStatement *s, elem *econd)
+{
+    size_t numcases = s->cases->dim;
+    if (!numcases)
+        return NULL;
+
+    /* The empty string is checked for separately, the others
+     * go in strs[], with their case index in index[].
+     */
+    StringExp **strs = (StringExp **)mem.xmalloc(numcases * sizeof(StringExp *));
+    size_t *index = (size_t *)mem.xmalloc(numcases * sizeof(size_t));
+    size_t n = 0;
+    int iempty = -1;
+    size_t minlen = ~(size_t)0;
+    size_t maxlen = 0;
+    for (size_t i = 0; i < numcases; i++)
+    {
+        CaseStatement *cs = (*s->cases)[i];
+        if (cs->exp->op != TOKstring)
+        {
+            mem.xfree(index);
+            mem.xfree(strs);
+            return NULL;
+        }
+        StringExp *se = (StringExp *)cs->exp;
+        size_t len = se->numberOfCodeUnits();
+        if (!len)
+        {
+            iempty = i;
+            continue;
+        }
+        strs[n] = se;
+        index[n] = i;
+        n++;
+        if (len < minlen)
+            minlen = len;
+        if (len > maxlen)
+            maxlen = len;
+    }
+
+    StringHash h;
+    if (n && !findStringHash(&h, strs, n, maxlen))
+    {
+        mem.xfree(index);
+        mem.xfree(strs);
+        return NULL;
+    }
+
+    int oplen = I64 ? OP128_64 : OP64_32;
+    Symbol *sstr = symbol_genauto(TYdarray);
+
+    // sstr = econd
+    elem *e = el_bin(OPeq, TYdarray, el_var(sstr), econd);
+
+    elem *er = el_long(TYint, -1);
+    if (n)
+        er = stringHashLookup(&h, strs, index, n, minlen, maxlen, sstr,
+                (unsigned)s->condition->type->nextOf()->size());
+
+    // sstr.length == 0 ? iempty : er
+    if (iempty != -1)
+        er = el_bin(OPcond, TYint,
+            el_bin(OPeqeq, TYint, el_una(oplen, TYsize_t, el_var(sstr)), el_long(TYsize_t, 0)),
+            el_bin(OPcolon, TYint, el_long(TYint, iempty), er));
+
+    mem.xfree(index);
+    mem.xfree(strs);
+    return el_combine(e, er);
+}
+
 void Statement_toIR(Statement *s, IRState *irs);
 
 class S2irVisitor : public Visitor
@@ -543,52 +979,61 @@ public:
 
             s->cases->sort();
 
-            /* Create a sorted array of the case strings, and si
-             * will be the symbol for it.
+            /* Look up the case with a perfect hash computed at compile time,
+             * instead of a binary search in the runtime library.
              */
-            Symbol *si = symbol_generate(SCstatic,type_fake(TYdarray));
-            DtBuilder dtb;
-            dtb.size(numcases);
-            dtb.xoff(si, Target::ptrsize * 2, TYnptr);
+            elem *ehash = switchStringHash(s, econd);
+            if (ehash)
+                econd = ehash;
+            else
+            {
+                /* Create a sorted array of the case strings, and si
+                 * will be the symbol for it.
+                 */
+                Symbol *si = symbol_generate(SCstatic,type_fake(TYdarray));
+                DtBuilder dtb;
+                dtb.size(numcases);
+                dtb.xoff(si, Target::ptrsize * 2, TYnptr);
 
-            for (size_t i = 0; i < numcases; i++)
-            {   CaseStatement *cs = (*s->cases)[i];
+                for (size_t i = 0; i < numcases; i++)
+                {   CaseStatement *cs = (*s->cases)[i];
 
-                if (cs->exp->op != TOKstring)
-                {   s->error("case '%s' is not a string", cs->exp->toChars()); // BUG: this should be an assert
-                }
-                else
-                {
-                    StringExp *se = (StringExp *)(cs->exp);
-                    Symbol *si = toStringSymbol(se);
-                    dtb.size(se->numberOfCodeUnits());
-                    dtb.xoff(si, 0);
+                    if (cs->exp->op != TOKstring)
+                    {   s->error("case '%s' is not a string", cs->exp->toChars()); // BUG: this should be an assert
+                    }
+                    else
+                    {
+                        StringExp *se = (StringExp *)(cs->exp);
+                        Symbol *si = toStringSymbol(se);
+                        dtb.size(se->numberOfCodeUnits());
+                        dtb.xoff(si, 0);
+                    }
                 }
-            }
 
-            si->Sdt = dtb.finish();
-            si->Sfl = FLdata;
-            outdata(si);
+                si->Sdt = dtb.finish();
+                si->Sfl = FLdata;
+                outdata(si);
 
-            /* Call:
-             *      _d_switch_string(string[] si, string econd)
-             */
-            if (config.exe == EX_WIN64)
-                econd = addressElem(econd, s->condition->type, true);
-            elem *eparam = el_param(econd, (config.exe == EX_WIN64) ? el_ptr(si) : el_var(si));
-            switch (s->condition->type->nextOf()->ty)
-            {
-                case Tchar:
-                    econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_STRING)), eparam);
-                    break;
-                case Twchar:
-                    econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_USTRING)), eparam);
-                    break;
-                case Tdchar:        // BUG: implement
-                    econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_DSTRING)), eparam);
-                    break;
-                default:
-                    assert(0);
+                /* Call:
+                 *      _d_switch_string(string[] si, string econd)
+                 */
+                if (config.exe == EX_WIN64)
+                    econd = addressElem(econd, s->condition->type, true);
+                elem *eparam = el_param(econd, (config.exe == EX_WIN64) ? el_ptr(si) : el_var(si));
+                switch (s->condition->type->nextOf()->ty)
+                {
+                    case Tchar:
+                        econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_STRING)), eparam);
+                        break;
+                    case Twchar:
+                        econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_USTRING)), eparam);
+                        break;
+                    case Tdchar:        // BUG: implement
+                        econd = el_bin(OPcall, TYint, el_var(getRtlsym(RTLSYM_SWITCH_DSTRING)), eparam);
+                        break;
+                    default:
+                        assert(0);
+                }
             }
             elem_setLoc(econd, s->loc);
             string = 1;
@@ -1325,29 +1770,39 @@ public:
             finallyblock->BS.BI_FINALLY.b_ret = retblock;
             assert(!finallyblock->Belem);
 
-            /* Add code to landingPad block:
-             *  exception_object = RAX;
-             *  _flag = 0;
+            /* If nothing in the body can throw, the landing pad is never
+             * entered. insertFinallyBlockCalls() then removes it, leaving
+             * the finally code as an ordinary part of the function.
              */
-            // Make it volatile so optimizer won't delete it
-            symbol *sreg = symbol_name("__EAX", SCpseudo, type_fake(mTYvolatile | TYnptr));
-            sreg->Sreglsw = 0;          // EAX, RAX, whatevs
-            symbol_add(sreg);
-            symbol *seo = symbol_name("__exception_object", SCauto, tspvoid);
-            symbol_add(seo);
-            assert(!landingPad->Belem);
-            elem *e = el_bin(OPeq, TYvoid, el_var(seo), el_var(sreg));
-            union eve c;
-            memset(&c, 0, sizeof(c));
-            landingPad->Belem = el_combine(e, el_bin(OPeq, TYvoid, el_var(sflag), el_const(TYint, &c)));
-
-            /* Add code to BC_ret block:
-             *  (!_flag && _Unwind_Resume(exception_object));
-             */
-            elem *eu = el_bin(OPcall, TYvoid, el_var(getRtlsym(RTLSYM_UNWIND_RESUME)), el_var(seo));
-            eu = el_bin(OPandand, TYvoid, el_una(OPnot, TYbool, el_var(sflag)), eu);
-            assert(!retblock->Belem);
-            retblock->Belem = eu;
+            bool nothrow = !s->_body ||
+                !(s->_body->blockExit(irs->getFunc(), false) & BEthrow);
+            finallyblock->BS.BI_FINALLY.nothrow = nothrow;
+            if (!nothrow)
+            {
+                /* Add code to landingPad block:
+                 *  exception_object = RAX;
+                 *  _flag = 0;
+                 */
+                // Make it volatile so optimizer won't delete it
+                symbol *sreg = symbol_name("__EAX", SCpseudo, type_fake(mTYvolatile | TYnptr));
+                sreg->Sreglsw = 0;          // EAX, RAX, whatevs
+                symbol_add(sreg);
+                symbol *seo = symbol_name("__exception_object", SCauto, tspvoid);
+                symbol_add(seo);
+                assert(!landingPad->Belem);
+                elem *e = el_bin(OPeq, TYvoid, el_var(seo), el_var(sreg));
+                union eve c;
+                memset(&c, 0, sizeof(c));
+                landingPad->Belem = el_combine(e, el_bin(OPeq, TYvoid, el_var(sflag), el_const(TYint, &c)));
+
+                /* Add code to BC_ret block:
+                 *  (!_flag && _Unwind_Resume(exception_object));
+                 */
+                elem *eu = el_bin(OPcall, TYvoid, el_var(getRtlsym(RTLSYM_UNWIND_RESUME)), el_var(seo));
+                eu = el_bin(OPandand, TYvoid, el_una(OPnot, TYbool, el_var(sflag)), eu);
+                assert(!retblock->Belem);
+                retblock->Belem = eu;
+            }
 
             IRState finallyState(irs, s);
 
@@ -1535,6 +1990,28 @@ void Statement_toIR(Statement *s, IRState *irs)
     s->accept(&v);
 }
 
+/***************************************************
+ * Remove a block that is no longer reachable from the Bnext
+ * list, and free it.
+ * Params:
+ *      bstart = a block that comes before bdead in the list
+ *      bdead = block to remove
+ */
+
+static void unlinkBlock(block *bstart, block *bdead)
+{
+    for (block *b = bstart; b->Bnext; b = b->Bnext)
+    {
+        if (b->Bnext == bdead)
+        {
+            b->Bnext = bdead->Bnext;
+            block_free(bdead);
+            return;
+        }
+    }
+    assert(0);
+}
+
 /***************************************************
  * Insert finally block calls when doing a goto from
  * inside a try block to outside.
@@ -1714,6 +2191,73 @@ void insertFinallyBlockCalls(block *startblock)
     if (bcretexp)
         *pb = bcretexp;
 
+    /* Take the exception handling out of try-finally's whose body cannot throw.
+     * From this:
+     *  BC_try     [body] [BC_finally]
+     *  body
+     *  BCgoto     sflag=n; [finalbody]
+     *  BC_finally [BC_lpad] [finalbody] [breakblock]
+     *  BC_lpad    [finalbody]
+     *  finalbody
+     *  BCgoto     [BCiftrue]
+     *  BCiftrue   (sflag==n) [breakblock]
+     *  BC_ret
+     *  breakblock
+     *
+     * Build this:
+     *  BCgoto     [body]
+     *  body
+     *  BCgoto     sflag=n; [finalbody]
+     *  finalbody
+     *  BCgoto     [BCgoto]
+     *  BCgoto     [breakblock]
+     *  breakblock
+     *
+     * The BC_finally, BC_lpad and BC_ret blocks are no longer reachable,
+     * and are unlinked and freed here. If the body never exits normally,
+     * there is no BCiftrue to rewrite and the BC_ret block is kept.
+     */
+    for (block *b = startblock; b; b = b->Bnext)
+    {
+        if (b->BC != BC_try)
+            continue;
+        block *bf = b->nthSucc(1);
+        if (bf->BC != BC_finally || !bf->BS.BI_FINALLY.nothrow)
+            continue;
+
+        // sflag is only ever set to the value of an exit, so the
+        // last test of it always succeeds
+        block *retblock = bf->BS.BI_FINALLY.b_ret;
+        bool retdead = false;
+        for (block *bt = bf; bt; bt = bt->Bnext)
+        {
+            if (bt->BC == BCiftrue && bt->nthSucc(1) == retblock)
+            {
+                el_free(bt->Belem);
+                bt->Belem = NULL;
+                bt->BC = BCgoto;
+                list_subtract(&bt->Bsucc, retblock);
+                retdead = true;
+                break;
+            }
+        }
+
+        for (block *bt = b->Bnext; bt; bt = bt->Bnext)
+        {
+            if (bt->Btry == b)
+                bt->Btry = b->Btry;
+        }
+        b->BC = BCgoto;
+        list_subtract(&b->Bsucc, bf);
+
+        block *lpad = bf->nthSucc(0);
+        assert(lpad->BC == BC_lpad);
+        unlinkBlock(b, lpad);
+        unlinkBlock(b, bf);
+        if (retdead)
+            unlinkBlock(b, retblock);
+    }
+
 #if 0
     printf("------- after ----------\n");
     for (block *b = startblock; b; b = b->Bnext) WRblock(b);
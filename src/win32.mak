@@ -164,7 +164,7 @@ GLUEOBJ=glue.obj msc.obj s2ir.obj e2ir.obj tocsym.obj \
 	iasm.obj objc_glue_stubs.obj
 
 # D back end
-BACKOBJ= go.obj gdag.obj gother.obj gflow.obj gloop.obj var.obj el.obj \
+BACKOBJ= go.obj gdag.obj gother.obj gssa.obj gflow.obj gloop.obj var.obj el.obj \
 	newman.obj glocal.obj os.obj nteh.obj evalu8.obj cgcs.obj \
 	rtlsym.obj cgelem.obj cgen.obj cgreg.obj out.obj \
 	blockopt.obj cgobj.obj cg.obj cgcv.obj type.obj dt.obj \
@@ -176,7 +176,7 @@ BACKOBJ= go.obj gdag.obj gother.obj gflow.obj gloop.obj var.obj el.obj \
 	ph2.obj util2.obj eh.obj tk.obj \
 
 # Root package
-ROOT_SRCS=$(ROOT)/aav.d $(ROOT)/array.d $(ROOT)/file.d $(ROOT)/filename.d	\
+ROOT_SRCS=$(ROOT)/aav.d $(ROOT)/array.d $(ROOT)/async.d $(ROOT)/file.d $(ROOT)/filename.d	\
 	$(ROOT)/longdouble.d $(ROOT)/man.d $(ROOT)/outbuffer.d $(ROOT)/port.d	\
 	$(ROOT)/response.d $(ROOT)/rmem.d $(ROOT)/rootobject.d			\
 	$(ROOT)/speller.d $(ROOT)/stringtable.d
@@ -205,17 +205,17 @@ BACKSRC= $C\cdef.h $C\cc.h $C\oper.h $C\ty.h $C\optabgen.c \
 	$C\el.h $C\iasm.h $C\rtlsym.h \
 	$C\bcomplex.c $C\blockopt.c $C\cg.c $C\cg87.c $C\cgxmm.c \
 	$C\cgcod.c $C\cgcs.c $C\cgcv.c $C\cgelem.c $C\cgen.c $C\cgobj.c \
-	$C\compress.c $C\cgreg.c $C\var.c \
+	$C\compress.c $C\deflate.c $C\cgreg.c $C\var.c \
 	$C\cgsched.c $C\cod1.c $C\cod2.c $C\cod3.c $C\cod4.c $C\cod5.c \
 	$C\code.c $C\symbol.c $C\debug.c $C\dt.c $C\ee.c $C\el.c \
 	$C\evalu8.c $C\go.c $C\gflow.c $C\gdag.c \
-	$C\gother.c $C\glocal.c $C\gloop.c $C\newman.c \
+	$C\gother.c $C\gssa.c $C\glocal.c $C\gloop.c $C\newman.c \
 	$C\nteh.c $C\os.c $C\out.c $C\outbuf.c $C\ptrntab.c $C\rtlsym.c \
 	$C\type.c $C\melf.h $C\mach.h $C\mscoff.h $C\bcomplex.h \
 	$C\outbuf.h $C\token.h $C\tassert.h \
 	$C\elfobj.c $C\cv4.h $C\dwarf2.h $C\exh.h $C\go.h \
 	$C\dwarf.c $C\dwarf.h $C\machobj.c \
-	$C\strtold.c $C\aa.h $C\aa.c $C\tinfo.h $C\ti_achar.c \
+	$C\strtold.c $C\aa.h $C\aa.c $C\hashtab.h $C\tinfo.h $C\ti_achar.c \
 	$C\md5.h $C\md5.c $C\ti_pvoid.c $C\xmm.h $C\ph2.c $C\util2.c \
 	$C\mscoffobj.c $C\obj.h $C\pdata.c $C\cv8.c $C\backconfig.c \
 	$C\divcoeff.c $C\dwarfeh.c \
@@ -230,7 +230,7 @@ ROOTSRCC=$(ROOT)\newdelete.c
 ROOTSRCD=$(ROOT)\rmem.d $(ROOT)\stringtable.d $(ROOT)\man.d $(ROOT)\port.d	\
 	$(ROOT)\response.d $(ROOT)\rootobject.d $(ROOT)\speller.d $(ROOT)\aav.d	\
 	$(ROOT)\longdouble.d $(ROOT)\outbuffer.d $(ROOT)\filename.d		\
-	$(ROOT)\file.d $(ROOT)\array.d
+	$(ROOT)\file.d $(ROOT)\array.d $(ROOT)\async.d
 ROOTSRC= $(ROOT)\root.h $(ROOT)\stringtable.h	\
 	$(ROOT)\longdouble.h $(ROOT)\outbuffer.h $(ROOT)\object.h		\
 	$(ROOT)\filename.h $(ROOT)\file.h $(ROOT)\array.h $(ROOT)\rmem.h $(ROOTSRCC)	\
@@ -472,7 +472,7 @@ divcoeff.obj : $C\divcoeff.c
 dt.obj : $C\dt.h $C\dt.c
 	$(CC) -c $(MFLAGS) $C\dt
 
-dwarf.obj : $C\dwarf.h $C\dwarf.c
+dwarf.obj : $C\dwarf.h $C\dwarf.c $C\hashtab.h
 	$(CC) -c $(MFLAGS) $C\dwarf
 
 ee.obj : $C\ee.c
@@ -499,6 +499,9 @@ gdag.obj : $C\gdag.c
 gother.obj : $C\gother.c
 	$(CC) -c $(MFLAGS) $C\gother
 
+gssa.obj : $C\gssa.c
+	$(CC) -c $(MFLAGS) $C\gssa
+
 glocal.obj : $C\rtlsym.h $C\glocal.c
 	$(CC) -c $(MFLAGS) $C\glocal
 
@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+src=runnable${SEP}extra-files
+dir=${RESULTS_DIR}${SEP}runnable
+output_file=${dir}/debugtypesig.sh.out
+
+if [ $OS == "linux" -o $OS == "freebsd" ]; then
+    # Each type unit is in a COMDAT group named after its signature
+    typeunits()
+    {
+        readelf -gW ${dir}${SEP}debugtypesig.o | grep -c '\[wt\.[0-9a-f]*\]'
+    }
+
+    # The two structs named debugtypesig.f.S have the same layout, and
+    # are the same type as far as the debugger can tell
+    $DMD -m${MODEL} -g -gtypes -version=Same -c -od${dir} ${src}${SEP}debugtypesig.d || exit 1
+    same=$(typeunits)
+
+    # Now their fields have different types, so they need a type unit each
+    $DMD -m${MODEL} -g -gtypes -c -od${dir} ${src}${SEP}debugtypesig.d || exit 1
+    different=$(typeunits)
+    [ ${different} -eq $((same + 1)) ] || exit 1
+
+    rm -f ${dir}${SEP}debugtypesig.o
+fi
+
+echo Success >${output_file}
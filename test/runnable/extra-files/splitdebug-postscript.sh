@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+
+# The debug info went to a .dwo file next to the object file
+dwo=${RESULTS_DIR}/runnable/splitdebug.dwo
+if [ ! -f ${dwo} ]; then
+    exit 1
+fi
+
+rm ${dwo}
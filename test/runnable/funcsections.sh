@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+
+src=runnable${SEP}extra-files
+dir=${RESULTS_DIR}${SEP}runnable
+output_file=${dir}/funcsections.sh.out
+
+if [ $OS == "linux" -o $OS == "freebsd" ]; then
+    obj=${dir}${SEP}funcsections.o
+    exe=${dir}${SEP}funcsections${EXE}
+
+    # Each function and global variable is in a section named after it
+    $DMD -m${MODEL} -function-sections -data-sections -c -od${dir} ${src}${SEP}funcsections.d || exit 1
+    sections=$(readelf -SW ${obj})
+    for s in .text._D12funcsections8usedFuncFiZi .text._D12funcsections10unusedFuncFiZi \
+             .data._D12funcsections4usedi .data._D12funcsections6unusedi \
+             .bss._D12funcsections6zeroedG100i; do
+        echo "${sections}" | grep -qF " ${s} " || exit 1
+    done
+
+    # so the linker can drop the ones nothing refers to
+    $DMD -m${MODEL} -of${exe} -L--gc-sections ${obj} || exit 1
+    ${exe} || exit 1
+    symbols=$(nm ${exe})
+    echo "${symbols}" | grep -q '_D12funcsections8usedFuncFiZi$' || exit 1
+    echo "${symbols}" | grep -q '_D12funcsections4usedi$' || exit 1
+    echo "${symbols}" | grep -q '_D12funcsections10unusedFuncFiZi$' && exit 1
+    echo "${symbols}" | grep -q '_D12funcsections6unusedi$' && exit 1
+
+    rm -f ${obj} ${exe}
+fi
+
+echo Success >${output_file}
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+
+src=runnable${SEP}extra-files
+dir=${RESULTS_DIR}${SEP}runnable
+output_file=${dir}/libthin.sh.out
+
+if [ $OS == "linux" -o $OS == "freebsd" ]; then
+    lib=${dir}${SEP}libthin.a
+    rm -f ${lib}
+
+    $DMD -m${MODEL} -c -od${dir} ${src}${SEP}libupdate_a.d ${src}${SEP}libupdate_c.d || exit 1
+    $DMD -m${MODEL} -c -version=B2 -od${dir} ${src}${SEP}libupdate_b.d || exit 1
+    $DMD -m${MODEL} -lib=thin -of${lib} ${dir}${SEP}libupdate_a.o ${dir}${SEP}libupdate_b.o ${dir}${SEP}libupdate_c.o || exit 1
+
+    # The members are not copied, only referred to relative to the library
+    [ "$(head -c 8 ${lib})" == '!<thin>' ] || exit 1
+    [ "$(ar t ${lib} | tr '\n' ' ')" == "libupdate_a.o libupdate_b.o libupdate_c.o " ] || exit 1
+    [ $(stat -c %s ${lib}) -lt $(stat -c %s ${dir}${SEP}libupdate_a.o) ] || exit 1
+
+    $DMD -m${MODEL} -I${src} -of${dir}${SEP}libthin${EXE} ${src}${SEP}libupdate.d ${lib} || exit 1
+    ${dir}${SEP}libthin${EXE} || exit 1
+
+    rm -f ${lib} ${dir}${SEP}{libupdate_a.o,libupdate_b.o,libupdate_c.o,libupdate.o,libthin${EXE}}
+fi
+
+echo Success >${output_file}
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+
+src=runnable${SEP}extra-files
+dir=${RESULTS_DIR}${SEP}runnable
+output_file=${dir}/libupdate.sh.out
+
+if [ $OS == "linux" -o $OS == "freebsd" ]; then
+    lib=${dir}${SEP}libupdate.a
+    rm -f ${lib}
+
+    $DMD -m${MODEL} -c -od${dir} ${src}${SEP}libupdate_a.d ${src}${SEP}libupdate_b.d || exit 1
+    $DMD -m${MODEL} -lib -of${lib} ${dir}${SEP}libupdate_a.o ${dir}${SEP}libupdate_b.o || exit 1
+    [ "$(ar t ${lib} | tr '\n' ' ')" == "libupdate_a.o libupdate_b.o " ] || exit 1
+
+    # Replace the member that changed, append the new one, keep the other
+    $DMD -m${MODEL} -c -version=B2 -of${dir}${SEP}libupdate_b.o ${src}${SEP}libupdate_b.d || exit 1
+    $DMD -m${MODEL} -c -od${dir} ${src}${SEP}libupdate_c.d || exit 1
+    $DMD -m${MODEL} -lib=update -of${lib} ${dir}${SEP}libupdate_b.o ${dir}${SEP}libupdate_c.o || exit 1
+    [ "$(ar t ${lib} | tr '\n' ' ')" == "libupdate_a.o libupdate_b.o libupdate_c.o " ] || exit 1
+    ar p ${lib} libupdate_b.o | cmp -s - ${dir}${SEP}libupdate_b.o || exit 1
+    ar p ${lib} libupdate_a.o | cmp -s - ${dir}${SEP}libupdate_a.o || exit 1
+
+    # Nothing changed, so the library must not be rewritten
+    inode=$(ls -i ${lib} | cut -d' ' -f1)
+    $DMD -m${MODEL} -lib=update -of${lib} ${dir}${SEP}libupdate_c.o || exit 1
+    [ "$(ls -i ${lib} | cut -d' ' -f1)" == "${inode}" ] || exit 1
+
+    $DMD -m${MODEL} -I${src} -of${dir}${SEP}libupdate${EXE} ${src}${SEP}libupdate.d ${lib} || exit 1
+    ${dir}${SEP}libupdate${EXE} || exit 1
+
+    rm -f ${lib} ${dir}${SEP}{libupdate_a.o,libupdate_b.o,libupdate_c.o,libupdate.o,libupdate${EXE}}
+fi
+
+echo Success >${output_file}
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+src=runnable${SEP}extra-files
+dir=${RESULTS_DIR}${SEP}runnable
+output_file=${dir}/splitdwarf.sh.out
+
+if [ $OS == "linux" -o $OS == "freebsd" ]; then
+    # Without -gsplit-dwarf, the object file names its functions in .debug_pubnames
+    $DMD -m${MODEL} -g -c -od${dir} ${src}${SEP}splitdwarf.d || exit 1
+    readelf -SW ${dir}${SEP}splitdwarf.o | grep -q '\.debug_pubnames' || exit 1
+    readelf --debug-dump=pubnames ${dir}${SEP}splitdwarf.o | grep -q 'manhattan' || exit 1
+
+    # With it, the DIEs are in the .dwo file, so there must be no
+    # .debug_pubnames pointing into the skeleton compile unit
+    rm -f ${dir}${SEP}splitdwarf.o
+    $DMD -m${MODEL} -g -gsplit-dwarf -c -od${dir} ${src}${SEP}splitdwarf.d || exit 1
+    readelf -SW ${dir}${SEP}splitdwarf.o | grep -q '\.debug_info' || exit 1
+    readelf -SW ${dir}${SEP}splitdwarf.o | grep -q '\.debug_pubnames' && exit 1
+    readelf -SW ${dir}${SEP}splitdwarf.dwo | grep -q '\.debug_info\.dwo' || exit 1
+
+    rm -f ${dir}${SEP}{splitdwarf.o,splitdwarf.dwo}
+fi
+
+echo Success >${output_file}